@@ -0,0 +1,63 @@
+/*
+ * Copyright 2015 Erik Van Hamme
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef BENCH_H
+#define BENCH_H
+
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+
+namespace bench {
+
+// Every measurement is repeated this many times and the fastest run is reported, to filter out scheduler noise.
+static constexpr int RUNS = 5;
+
+/**
+ * @brief Calls f() runs times and returns the fastest call in nanoseconds per operation.
+ *
+ * @param [in] operations The number of operations one call of f performs.
+ * @param [in] runs The number of calls, 1 for operations that cannot be repeated on the same data.
+ */
+template <typename F>
+double nanosecondsPerOperation(std::size_t operations, F f, int runs = RUNS) {
+    double best = 0.0;
+    for (int run = 0; run < runs; ++run) {
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        f();
+        std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+
+        double ns = std::chrono::duration<double, std::nano>(end - start).count() / static_cast<double>(operations);
+        if ((run == 0) || (ns < best)) {
+            best = ns;
+        }
+    }
+    return best;
+}
+
+// Keeps the compiler from optimising away a computed value.
+template <typename T>
+inline void keep(const T &value) {
+    asm volatile("" : : "r,m"(value) : "memory");
+}
+
+inline void report(const char *name, double ns) {
+    std::printf("%-40s %10.2f ns/op\n", name, ns);
+}
+
+} // bench
+
+#endif // BENCH_H
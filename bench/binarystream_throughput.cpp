@@ -0,0 +1,178 @@
+/*
+ * Copyright 2015 Erik Van Hamme
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Throughput of BinaryWriter and BinaryReader in both byte orders: checked field by field access, one require() per
+// record with unchecked fields, bulk arrays and varints, against a plain memcpy of the same bytes.
+
+#include "bench.h"
+
+#include "binarystream.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+namespace {
+
+constexpr std::size_t RECORDS = 1 << 18;
+
+// One record is a uint32, a uint16, a float and a uint64: 18 bytes on the wire.
+constexpr std::size_t RECORD_SIZE = 4 + 2 + 4 + 8;
+
+constexpr std::size_t BYTES = RECORDS * RECORD_SIZE;
+
+struct Record {
+    std::uint32_t id;
+    std::uint16_t flags;
+    float value;
+    std::uint64_t time;
+};
+
+void report(const char *name, double nsPerByte) {
+    std::printf("%-40s %8.2f GB/s\n", name, 1.0 / nsPerByte);
+}
+
+template <ecpp::ByteOrder ORDER>
+void run(const char *order, const std::vector<Record> &records, std::vector<std::uint8_t> &buffer) {
+    std::printf("%s\n", order);
+
+    std::vector<Record> decoded(RECORDS);
+
+    report("write, checked per field", bench::nanosecondsPerOperation(BYTES, [&records, &buffer] {
+        ecpp::BinaryWriter<ORDER> writer(buffer.data(), buffer.size());
+        for (const Record &record : records) {
+            writer.write(record.id);
+            writer.write(record.flags);
+            writer.write(record.value);
+            writer.write(record.time);
+        }
+        bench::keep(writer.failed());
+    }));
+
+    report("write, require per record", bench::nanosecondsPerOperation(BYTES, [&records, &buffer] {
+        ecpp::BinaryWriter<ORDER> writer(buffer.data(), buffer.size());
+        for (const Record &record : records) {
+            if (writer.require(RECORD_SIZE) == false) {
+                break;
+            }
+            writer.put(record.id);
+            writer.put(record.flags);
+            writer.put(record.value);
+            writer.put(record.time);
+        }
+        bench::keep(writer.failed());
+    }));
+
+    report("read, checked per field", bench::nanosecondsPerOperation(BYTES, [&decoded, &buffer] {
+        ecpp::BinaryReader<ORDER> reader(buffer.data(), buffer.size());
+        for (Record &record : decoded) {
+            reader.read(record.id);
+            reader.read(record.flags);
+            reader.read(record.value);
+            reader.read(record.time);
+        }
+        bench::keep(reader.failed());
+    }));
+
+    report("read, require per record", bench::nanosecondsPerOperation(BYTES, [&decoded, &buffer] {
+        ecpp::BinaryReader<ORDER> reader(buffer.data(), buffer.size());
+        for (Record &record : decoded) {
+            if (reader.require(RECORD_SIZE) == false) {
+                break;
+            }
+            record.id = reader.template get<std::uint32_t>();
+            record.flags = reader.template get<std::uint16_t>();
+            record.value = reader.template get<float>();
+            record.time = reader.template get<std::uint64_t>();
+        }
+        bench::keep(reader.failed());
+    }));
+
+    for (std::size_t i = 0; i < RECORDS; ++i) {
+        if ((decoded[i].id != records[i].id) || (decoded[i].flags != records[i].flags) ||
+                (decoded[i].value != records[i].value) || (decoded[i].time != records[i].time)) {
+            std::printf("record %zu differs after decoding\n", i);
+            break;
+        }
+    }
+
+    std::vector<std::uint32_t> words(BYTES / sizeof(std::uint32_t), 0x01020304u);
+
+    report("writeArray uint32", bench::nanosecondsPerOperation(BYTES, [&words, &buffer] {
+        ecpp::BinaryWriter<ORDER> writer(buffer.data(), buffer.size());
+        writer.writeArray(words.data(), words.size());
+        bench::keep(writer.failed());
+    }));
+
+    report("readArray uint32", bench::nanosecondsPerOperation(BYTES, [&words, &buffer] {
+        ecpp::BinaryReader<ORDER> reader(buffer.data(), buffer.size());
+        reader.readArray(words.data(), words.size());
+        bench::keep(reader.failed());
+    }));
+}
+
+} // anonymous
+
+int main() {
+    std::vector<Record> records(RECORDS);
+    for (std::size_t i = 0; i < RECORDS; ++i) {
+        records[i].id = static_cast<std::uint32_t>(i);
+        records[i].flags = static_cast<std::uint16_t>(i * 7);
+        records[i].value = static_cast<float>(i) * 0.5f;
+        records[i].time = static_cast<std::uint64_t>(i) * 1000003u;
+    }
+
+    std::vector<std::uint8_t> buffer(BYTES);
+    std::vector<std::uint8_t> copy(BYTES);
+
+    report("memcpy", bench::nanosecondsPerOperation(BYTES, [&buffer, &copy] {
+        std::memcpy(copy.data(), buffer.data(), BYTES);
+        bench::keep(copy[0]);
+    }));
+
+    run<ecpp::ByteOrder::LITTLE>("little endian", records, buffer);
+    run<ecpp::ByteOrder::BIG>("big endian", records, buffer);
+
+    // Values of growing magnitude, so the varints take 1 to 5 bytes.
+    std::vector<std::uint64_t> values(RECORDS);
+    for (std::size_t i = 0; i < RECORDS; ++i) {
+        values[i] = static_cast<std::uint64_t>(i) * (i & 0xffff);
+    }
+
+    std::size_t varintBytes = 0;
+    double writeNs = bench::nanosecondsPerOperation(RECORDS, [&values, &buffer, &varintBytes] {
+        ecpp::BinaryWriter<> writer(buffer.data(), buffer.size());
+        for (std::uint64_t value : values) {
+            writer.writeVarint(value);
+        }
+        varintBytes = writer.position();
+    });
+    double readNs = bench::nanosecondsPerOperation(RECORDS, [&values, &buffer, varintBytes] {
+        ecpp::BinaryReader<> reader(buffer.data(), varintBytes);
+        for (std::uint64_t &value : values) {
+            reader.readVarint(value);
+        }
+        bench::keep(reader.failed());
+    });
+
+    std::printf("varints, %.2f bytes per value\n", static_cast<double>(varintBytes) / RECORDS);
+    bench::report("writeVarint", writeNs);
+    bench::report("readVarint", readNs);
+
+    return 0;
+}
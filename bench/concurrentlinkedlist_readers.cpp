@@ -0,0 +1,155 @@
+/*
+ * Copyright 2015 Erik Van Hamme
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Read throughput of ConcurrentLinkedList for 1 to MAX_READERS readers while one writer keeps changing the list, against
+// a std::list behind a pthread reader-writer lock, C++11 has no std::shared_mutex. Both writers remove an item and append
+// it again. Usage: concurrentlinkedlist_readers [max readers].
+
+#include "bench.h"
+
+#include "allocator.h"
+#include "concurrentlinkedlist.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <list>
+#include <thread>
+#include <vector>
+
+#include <pthread.h>
+
+namespace {
+
+constexpr std::size_t MAX_READERS = 8;
+constexpr int ITEMS = 256;
+constexpr std::chrono::milliseconds DURATION(300);
+
+typedef ecpp::ConcurrentLinkedList<int, MAX_READERS> List;
+
+struct Result {
+    double traversals;
+    double writes;
+};
+
+// Runs readers and one writer for DURATION, read(reader) traverses the list once and write(i) changes it once.
+template <typename Tread, typename Twrite>
+Result measure(std::size_t readers, Tread read, Twrite write) {
+    std::atomic<bool> stop(false);
+    std::atomic<std::uint64_t> traversals(0);
+    std::uint64_t writes = 0;
+
+    std::vector<std::thread> threads;
+    for (std::size_t r = 0; r < readers; ++r) {
+        threads.emplace_back([&stop, &traversals, &read, r] {
+            std::uint64_t count = 0;
+            long sum = 0;
+            while (stop.load(std::memory_order_relaxed) == false) {
+                sum += read(r);
+                ++count;
+            }
+            bench::keep(sum);
+            traversals.fetch_add(count, std::memory_order_relaxed);
+        });
+    }
+
+    std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now() + DURATION;
+    while (std::chrono::steady_clock::now() < end) {
+        write(static_cast<int>(writes % ITEMS));
+        ++writes;
+    }
+    stop.store(true, std::memory_order_relaxed);
+
+    for (std::thread &thread : threads) {
+        thread.join();
+    }
+
+    double seconds = std::chrono::duration<double>(DURATION).count();
+    return Result {static_cast<double>(traversals.load()) / seconds, static_cast<double>(writes) / seconds};
+}
+
+} // anonymous
+
+int main(int argc, char **argv) {
+    std::size_t maxReaders = MAX_READERS;
+    if (argc > 1) {
+        maxReaders = static_cast<std::size_t>(std::strtoul(argv[1], nullptr, 10));
+    }
+    if ((maxReaders == 0) || (maxReaders > MAX_READERS)) {
+        maxReaders = MAX_READERS;
+    }
+
+    std::printf("list of %d items, traversals and writes per second, %u hardware threads\n", ITEMS,
+            std::thread::hardware_concurrency());
+    std::printf("%8s %18s %14s %18s %14s\n", "readers", "lock free reads", "writes", "rwlock reads", "writes");
+
+    for (std::size_t readers = 1; readers <= maxReaders; ++readers) {
+        ecpp::Allocator allocator;
+
+        List list(allocator);
+        for (int i = 0; i < ITEMS; ++i) {
+            list.append(i);
+        }
+        Result lockFree = measure(readers, [&list](std::size_t reader) {
+            long sum = 0;
+            List::ReadGuard guard(list, reader);
+            for (const int &item : guard) {
+                sum += item;
+            }
+            return sum;
+        }, [&list](int item) {
+            list.remove(item);
+            list.append(item);
+        });
+
+        // The glibc default prefers readers, back to back readers would then starve the writer.
+        pthread_rwlockattr_t attributes;
+        pthread_rwlockattr_init(&attributes);
+#ifdef __GLIBC__
+        pthread_rwlockattr_setkind_np(&attributes, PTHREAD_RWLOCK_PREFER_WRITER_NONRECURSIVE_NP);
+#endif
+        pthread_rwlock_t lock;
+        pthread_rwlock_init(&lock, &attributes);
+        pthread_rwlockattr_destroy(&attributes);
+        std::list<int> locked;
+        for (int i = 0; i < ITEMS; ++i) {
+            locked.push_back(i);
+        }
+        Result rwlocked = measure(readers, [&lock, &locked](std::size_t) {
+            long sum = 0;
+            pthread_rwlock_rdlock(&lock);
+            for (const int &item : locked) {
+                sum += item;
+            }
+            pthread_rwlock_unlock(&lock);
+            return sum;
+        }, [&lock, &locked](int item) {
+            pthread_rwlock_wrlock(&lock);
+            locked.remove(item);
+            locked.push_back(item);
+            pthread_rwlock_unlock(&lock);
+        });
+        pthread_rwlock_destroy(&lock);
+
+        std::printf("%8zu %18.0f %14.0f %18.0f %14.0f\n", readers, lockFree.traversals, lockFree.writes,
+                rwlocked.traversals, rwlocked.writes);
+    }
+
+    return 0;
+}
@@ -0,0 +1,107 @@
+/*
+ * Copyright 2015 Erik Van Hamme
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Cost of creating and destroying Task frames: global heap, FrameAllocatorScope and allocator_arg on a PoolAllocator.
+
+#include "bench.h"
+
+#include "coroutine.h"
+#include "poolallocator.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+
+#ifdef ECPP_HAVE_COROUTINES
+
+namespace {
+
+// Tasks are created in batches, so the allocators hold several frames at once as in real use.
+constexpr std::size_t BATCH = 64;
+constexpr std::size_t ROUNDS = 20000;
+
+ecpp::Task<int> task(int value) {
+    co_return value;
+}
+
+ecpp::Task<int> taskFrom(std::allocator_arg_t, ecpp::Allocator &, int value) {
+    co_return value;
+}
+
+template <typename F>
+double createDestroy(F create) {
+    return bench::nanosecondsPerOperation(BATCH * ROUNDS, [&create] {
+        for (std::size_t round = 0; round < ROUNDS; ++round) {
+            ecpp::Task<int> tasks[BATCH];
+            for (std::size_t i = 0; i < BATCH; ++i) {
+                tasks[i] = create(static_cast<int>(i));
+            }
+            bench::keep(tasks);
+        }
+    });
+}
+
+template <typename F>
+double createRunDestroy(F create) {
+    return bench::nanosecondsPerOperation(BATCH * ROUNDS, [&create] {
+        int sum = 0;
+        for (std::size_t round = 0; round < ROUNDS; ++round) {
+            for (std::size_t i = 0; i < BATCH; ++i) {
+                ecpp::Task<int> t = create(static_cast<int>(i));
+                t.resume();
+                sum += t.result();
+            }
+        }
+        bench::keep(sum);
+    });
+}
+
+} // anonymous
+
+#endif // ECPP_HAVE_COROUTINES
+
+int main() {
+#ifdef ECPP_HAVE_COROUTINES
+    static std::uint8_t poolMem[256 * 1024];
+    ecpp::PoolAllocator pool(sizeof(poolMem), 64, poolMem);
+
+    auto heapTask = [](int value) {
+        return task(value);
+    };
+    auto scopedTask = [&pool](int value) {
+        ecpp::FrameAllocatorScope scope(pool);
+        return task(value);
+    };
+    auto poolTask = [&pool](int value) {
+        return taskFrom(std::allocator_arg, pool, value);
+    };
+
+    std::printf("create + destroy, batches of %zu\n", BATCH);
+    bench::report("default heap", createDestroy(heapTask));
+    bench::report("FrameAllocatorScope(PoolAllocator)", createDestroy(scopedTask));
+    bench::report("allocator_arg PoolAllocator", createDestroy(poolTask));
+
+    std::printf("create + run + destroy\n");
+    bench::report("default heap", createRunDestroy(heapTask));
+    bench::report("FrameAllocatorScope(PoolAllocator)", createRunDestroy(scopedTask));
+    bench::report("allocator_arg PoolAllocator", createRunDestroy(poolTask));
+#else
+    std::printf("coroutines are not supported by this compiler\n");
+#endif
+
+    return 0;
+}
@@ -0,0 +1,148 @@
+/*
+ * Copyright 2015 Erik Van Hamme
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// HashMap against std::unordered_map: inserts, successful and failing lookups and erases of random 64 bit keys.
+
+#include "bench.h"
+
+#include "allocator.h"
+#include "hashmap.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <random>
+#include <unordered_map>
+#include <vector>
+
+namespace {
+
+constexpr std::size_t KEYS = 1 << 20;
+
+void run(const char *name, std::size_t keyCount, const std::vector<std::uint64_t> &keys,
+        const std::vector<std::uint64_t> &missing) {
+
+    ecpp::Allocator allocator;
+
+    std::printf("%s, %zu keys\n", name, keyCount);
+
+    double ecppInsert = bench::nanosecondsPerOperation(keyCount, [&] {
+        ecpp::HashMap<std::uint64_t, std::uint64_t> map(allocator, keyCount);
+        for (std::size_t i = 0; i < keyCount; ++i) {
+            map.insert(keys[i], i);
+        }
+        bench::keep(map.size());
+    });
+    double stdInsert = bench::nanosecondsPerOperation(keyCount, [&] {
+        std::unordered_map<std::uint64_t, std::uint64_t> map;
+        map.reserve(keyCount);
+        for (std::size_t i = 0; i < keyCount; ++i) {
+            map.emplace(keys[i], i);
+        }
+        bench::keep(map.size());
+    });
+
+    ecpp::HashMap<std::uint64_t, std::uint64_t> ecppMap(allocator, keyCount);
+    std::unordered_map<std::uint64_t, std::uint64_t> stdMap;
+    stdMap.reserve(keyCount);
+    for (std::size_t i = 0; i < keyCount; ++i) {
+        ecppMap.insert(keys[i], i);
+        stdMap.emplace(keys[i], i);
+    }
+
+    double ecppHit = bench::nanosecondsPerOperation(keyCount, [&] {
+        std::uint64_t sum = 0;
+        for (std::size_t i = 0; i < keyCount; ++i) {
+            sum += *ecppMap.find(keys[i]);
+        }
+        bench::keep(sum);
+    });
+    double stdHit = bench::nanosecondsPerOperation(keyCount, [&] {
+        std::uint64_t sum = 0;
+        for (std::size_t i = 0; i < keyCount; ++i) {
+            sum += stdMap.find(keys[i])->second;
+        }
+        bench::keep(sum);
+    });
+
+    double ecppMiss = bench::nanosecondsPerOperation(keyCount, [&] {
+        std::size_t found = 0;
+        for (std::size_t i = 0; i < keyCount; ++i) {
+            found += (ecppMap.find(missing[i]) != nullptr) ? 1 : 0;
+        }
+        bench::keep(found);
+    });
+    double stdMiss = bench::nanosecondsPerOperation(keyCount, [&] {
+        std::size_t found = 0;
+        for (std::size_t i = 0; i < keyCount; ++i) {
+            found += (stdMap.find(missing[i]) != stdMap.end()) ? 1 : 0;
+        }
+        bench::keep(found);
+    });
+
+    // Every run erases from a fresh copy of the filled map, the filling is not part of the time.
+    double ecppErase = 0.0;
+    double stdErase = 0.0;
+    for (int run = 0; run < bench::RUNS; ++run) {
+        ecpp::HashMap<std::uint64_t, std::uint64_t> e(allocator, keyCount);
+        std::unordered_map<std::uint64_t, std::uint64_t> s;
+        s.reserve(keyCount);
+        for (std::size_t i = 0; i < keyCount; ++i) {
+            e.insert(keys[i], i);
+            s.emplace(keys[i], i);
+        }
+
+        double ns = bench::nanosecondsPerOperation(keyCount, [&] {
+            for (std::size_t i = 0; i < keyCount; ++i) {
+                e.erase(keys[i]);
+            }
+        }, 1);
+        ecppErase = ((run == 0) || (ns < ecppErase)) ? ns : ecppErase;
+
+        ns = bench::nanosecondsPerOperation(keyCount, [&] {
+            for (std::size_t i = 0; i < keyCount; ++i) {
+                s.erase(keys[i]);
+            }
+        }, 1);
+        stdErase = ((run == 0) || (ns < stdErase)) ? ns : stdErase;
+    }
+
+    std::printf("%-12s %14s %14s %10s\n", "", "ecpp::HashMap", "unordered_map", "ratio");
+    std::printf("%-12s %14.2f %14.2f %10.2f\n", "insert", ecppInsert, stdInsert, stdInsert / ecppInsert);
+    std::printf("%-12s %14.2f %14.2f %10.2f\n", "find hit", ecppHit, stdHit, stdHit / ecppHit);
+    std::printf("%-12s %14.2f %14.2f %10.2f\n", "find miss", ecppMiss, stdMiss, stdMiss / ecppMiss);
+    std::printf("%-12s %14.2f %14.2f %10.2f\n", "erase", ecppErase, stdErase, stdErase / ecppErase);
+}
+
+} // anonymous
+
+int main() {
+    std::mt19937_64 random(42);
+
+    // The missing keys are odd, the keys in the map even.
+    std::vector<std::uint64_t> keys(KEYS);
+    std::vector<std::uint64_t> missing(KEYS);
+    for (std::size_t i = 0; i < KEYS; ++i) {
+        keys[i] = random() & ~static_cast<std::uint64_t>(1);
+        missing[i] = random() | 1;
+    }
+
+    std::printf("times in ns per operation, ratio > 1 means HashMap is faster\n");
+    run("in cache", 4096, keys, missing);
+    run("out of cache", KEYS, keys, missing);
+
+    return 0;
+}
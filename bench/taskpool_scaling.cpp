@@ -0,0 +1,109 @@
+/*
+ * Copyright 2015 Erik Van Hamme
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Scaling of TaskPool over the number of workers: a flat parallelFor and a recursive fork/join with TaskGroup.
+// Usage: taskpool_scaling [max workers], the default is one per hardware thread.
+
+#include "bench.h"
+
+#include "poolallocator.h"
+#include "taskpool.h"
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+
+namespace {
+
+constexpr std::size_t ELEMENTS = 1 << 22;
+constexpr std::size_t GRAIN = 4096;
+constexpr int FIB = 32;
+constexpr int FIB_CUTOFF = 16;
+
+// Task slots come from 64 byte blocks, which is exactly one slot each.
+std::uint8_t poolMem[8 * 1024 * 1024];
+
+long fibSequential(int n) {
+    return (n < 2) ? n : (fibSequential(n - 1) + fibSequential(n - 2));
+}
+
+long fib(ecpp::TaskPool &pool, int n) {
+    if (n < FIB_CUTOFF) {
+        return fibSequential(n);
+    }
+
+    long x;
+    ecpp::TaskGroup group(pool);
+    group.run([&pool, &x, n] {
+        x = fib(pool, n - 1);
+    });
+    long y = fib(pool, n - 2);
+    group.wait();
+
+    return x + y;
+}
+
+} // anonymous
+
+int main(int argc, char **argv) {
+    std::size_t maxWorkers = std::thread::hardware_concurrency();
+    if (argc > 1) {
+        maxWorkers = static_cast<std::size_t>(std::strtoul(argv[1], nullptr, 10));
+    }
+    if (maxWorkers == 0) {
+        maxWorkers = 1;
+    }
+
+    std::vector<double> data(ELEMENTS, 1.0);
+
+    std::printf("%8s %16s %10s %16s %10s\n", "workers", "parallelFor ms", "speedup", "fork/join ms", "speedup");
+
+    double forBase = 0.0;
+    double fibBase = 0.0;
+    for (std::size_t workers = 1; workers <= maxWorkers; ++workers) {
+        ecpp::PoolAllocator allocator(sizeof(poolMem), ecpp::TaskPool::TASK_SIZE, poolMem);
+        ecpp::TaskPool pool(allocator, workers);
+        if (pool.workerCount() != workers) {
+            std::printf("could not start %zu workers\n", workers);
+            break;
+        }
+
+        double forMs = bench::nanosecondsPerOperation(1000000, [&pool, &data] {
+            pool.parallelFor(0, data.size(), GRAIN, [&data](std::size_t i) {
+                data[i] = std::sqrt(data[i] * 1.0000001 + 0.5);
+            });
+        });
+
+        long result = 0;
+        double fibMs = bench::nanosecondsPerOperation(1000000, [&pool, &result] {
+            result = fib(pool, FIB);
+        });
+        bench::keep(result);
+
+        if (workers == 1) {
+            forBase = forMs;
+            fibBase = fibMs;
+        }
+
+        std::printf("%8zu %16.2f %10.2f %16.2f %10.2f\n", workers, forMs, forBase / forMs, fibMs, fibBase / fibMs);
+    }
+
+    return 0;
+}
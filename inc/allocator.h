@@ -28,6 +28,16 @@ public:
 
     virtual void *allocate(std::size_t size);
     virtual void deallocate(void *address);
+
+    /**
+     * @brief Tries to grow or shrink an allocation without moving it.
+     *
+     * @param [in] address The address returned by allocate.
+     * @param [in] size The new size in bytes.
+     *
+     * @return True if the allocation at address now holds at least size bytes, false if it was left as it was.
+     */
+    virtual bool resize(void *address, std::size_t size);
 };
 
 } // ecpp
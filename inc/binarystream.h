@@ -0,0 +1,290 @@
+/*
+ * Copyright 2015 Erik Van Hamme
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef BINARYSTREAM_H
+#define BINARYSTREAM_H
+
+#include "endiantypes.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+namespace ecpp {
+
+/**
+ * @brief Reads fixed size values in ORDER, varints and arrays from a buffer, front to back.
+ *
+ * Every checked read verifies that there is enough data left. For a block of fixed size fields, call require() once
+ * for the whole block and use the unchecked get() for the fields. Once a checked read fails the reader stays failed,
+ * so a sequence of reads can be checked with a single look at failed() at the end.
+ */
+template <ByteOrder ORDER = ByteOrder::LITTLE>
+class BinaryReader {
+public:
+    BinaryReader(const void *data, std::size_t size) : _data(static_cast<const std::uint8_t *>(data)), _size(size),
+            _position(0), _failed(false) {
+    }
+
+    std::size_t position() const {
+        return _position;
+    }
+
+    std::size_t remaining() const {
+        return _size - _position;
+    }
+
+    bool failed() const {
+        return _failed;
+    }
+
+    /**
+     * @brief Checks that at least bytes bytes are left, marks the reader as failed if not.
+     *
+     * @return True if the bytes can be read.
+     */
+    bool require(std::size_t bytes) {
+        if ((_failed == true) || (bytes > remaining())) {
+            _failed = true;
+            return false;
+        }
+        return true;
+    }
+
+    /**
+     * @brief Reads a value without checking the bounds, a preceding require() must cover it.
+     */
+    template <typename T>
+    T get() {
+        T value = EndianConverter<T, ORDER>::load(_data + _position);
+        _position += sizeof(T);
+        return value;
+    }
+
+    /**
+     * @brief Reads a value.
+     *
+     * @return True on success, false if there was not enough data. Value is left unchanged on failure.
+     */
+    template <typename T>
+    bool read(T &value) {
+        if (require(sizeof(T)) == false) {
+            return false;
+        }
+        value = get<T>();
+        return true;
+    }
+
+    /**
+     * @brief Reads count values of type T into values, converted in bulk.
+     *
+     * @return True on success, false if there was not enough data.
+     */
+    template <typename T>
+    bool readArray(T *values, std::size_t count) {
+        if ((count > (remaining() / sizeof(T))) || (require(count * sizeof(T)) == false)) {
+            _failed = true;
+            return false;
+        }
+        EndianConverter<T, ORDER>::load(values, _data + _position, count);
+        _position += count * sizeof(T);
+        return true;
+    }
+
+    /**
+     * @brief Returns a pointer to the next bytes bytes in the buffer and moves past them, without copying.
+     *
+     * @return The bytes, or nullptr if there was not enough data.
+     */
+    const void *readBytes(std::size_t bytes) {
+        if (require(bytes) == false) {
+            return nullptr;
+        }
+        const void *p = _data + _position;
+        _position += bytes;
+        return p;
+    }
+
+    bool skip(std::size_t bytes) {
+        return readBytes(bytes) != nullptr;
+    }
+
+    /**
+     * @brief Reads an unsigned LEB128 varint of up to 10 bytes.
+     *
+     * @return True on success, false if the data ran out or the varint does not fit in 64 bits.
+     */
+    bool readVarint(std::uint64_t &value) {
+        std::uint64_t result = 0;
+        for (unsigned int shift = 0; shift < 64; shift += 7) {
+            if (require(1) == false) {
+                return false;
+            }
+            std::uint8_t byte = _data[_position];
+            ++_position;
+
+            result |= static_cast<std::uint64_t>(byte & 0x7fu) << shift;
+            if ((byte & 0x80u) == 0) {
+                // The tenth byte can only hold the top bit.
+                if ((shift == 63) && (byte > 1)) {
+                    break;
+                }
+                value = result;
+                return true;
+            }
+        }
+        _failed = true;
+        return false;
+    }
+
+    /**
+     * @brief Reads a signed varint in zigzag encoding.
+     */
+    bool readZigzag(std::int64_t &value) {
+        std::uint64_t raw;
+        if (readVarint(raw) == false) {
+            return false;
+        }
+        value = static_cast<std::int64_t>(raw >> 1) ^ -static_cast<std::int64_t>(raw & 1u);
+        return true;
+    }
+
+private:
+    const std::uint8_t *_data;
+    std::size_t _size;
+    std::size_t _position;
+    bool _failed;
+};
+
+/**
+ * @brief Writes fixed size values in ORDER, varints and arrays into a buffer, front to back.
+ *
+ * Bounds are handled as for BinaryReader: require() once per block of fixed size fields and the unchecked put() for
+ * the fields, or the checked write functions. A failed write leaves the writer failed.
+ */
+template <ByteOrder ORDER = ByteOrder::LITTLE>
+class BinaryWriter {
+public:
+    BinaryWriter(void *data, std::size_t size) : _data(static_cast<std::uint8_t *>(data)), _size(size), _position(0),
+            _failed(false) {
+    }
+
+    std::size_t position() const {
+        return _position;
+    }
+
+    std::size_t remaining() const {
+        return _size - _position;
+    }
+
+    bool failed() const {
+        return _failed;
+    }
+
+    /**
+     * @brief Checks that there is room for at least bytes bytes, marks the writer as failed if not.
+     *
+     * @return True if the bytes can be written.
+     */
+    bool require(std::size_t bytes) {
+        if ((_failed == true) || (bytes > remaining())) {
+            _failed = true;
+            return false;
+        }
+        return true;
+    }
+
+    /**
+     * @brief Writes a value without checking the bounds, a preceding require() must cover it.
+     */
+    template <typename T>
+    void put(T value) {
+        EndianConverter<T, ORDER>::store(_data + _position, value);
+        _position += sizeof(T);
+    }
+
+    /**
+     * @brief Writes a value.
+     *
+     * @return True on success, false if there was no room.
+     */
+    template <typename T>
+    bool write(T value) {
+        if (require(sizeof(T)) == false) {
+            return false;
+        }
+        put(value);
+        return true;
+    }
+
+    /**
+     * @brief Writes count values of type T, converted in bulk.
+     *
+     * @return True on success, false if there was no room.
+     */
+    template <typename T>
+    bool writeArray(const T *values, std::size_t count) {
+        if ((count > (remaining() / sizeof(T))) || (require(count * sizeof(T)) == false)) {
+            _failed = true;
+            return false;
+        }
+        EndianConverter<T, ORDER>::store(_data + _position, values, count);
+        _position += count * sizeof(T);
+        return true;
+    }
+
+    bool writeBytes(const void *bytes, std::size_t size) {
+        if (require(size) == false) {
+            return false;
+        }
+        std::memcpy(_data + _position, bytes, size);
+        _position += size;
+        return true;
+    }
+
+    /**
+     * @brief Writes an unsigned LEB128 varint, 1 to 10 bytes.
+     */
+    bool writeVarint(std::uint64_t value) {
+        std::uint8_t bytes[10];
+        std::size_t size = 0;
+        while (value >= 0x80u) {
+            bytes[size] = static_cast<std::uint8_t>(value | 0x80u);
+            ++size;
+            value >>= 7;
+        }
+        bytes[size] = static_cast<std::uint8_t>(value);
+        ++size;
+        return writeBytes(bytes, size);
+    }
+
+    /**
+     * @brief Writes a signed varint in zigzag encoding, so values close to 0 take few bytes.
+     */
+    bool writeZigzag(std::int64_t value) {
+        return writeVarint((static_cast<std::uint64_t>(value) << 1) ^ static_cast<std::uint64_t>(value >> 63));
+    }
+
+private:
+    std::uint8_t *_data;
+    std::size_t _size;
+    std::size_t _position;
+    bool _failed;
+};
+
+} // ecpp
+
+#endif // BINARYSTREAM_H
@@ -0,0 +1,777 @@
+/*
+ * Copyright 2015 Erik Van Hamme
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef BTREE_H
+#define BTREE_H
+
+#include "allocator.h"
+#include "comparator.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <utility>
+
+namespace ecpp {
+
+// This prototype is required to make sure BTreeMap can be used in the definition of BTreeIterator.
+template <typename K, typename V, typename Tcomparator, std::size_t NODE_SIZE>
+class BTreeMap;
+
+/**
+ * @brief Node layouts of a BTreeMap, every node takes exactly NODE_SIZE bytes from the allocator.
+ */
+template <typename K, typename V, std::size_t NODE_SIZE>
+struct BTreeNodes {
+    struct Node {
+        bool leaf;
+        std::uint16_t count;
+    };
+
+    // Room for padding between the members, so the nodes are sure to fit in NODE_SIZE bytes.
+    static constexpr std::size_t SLACK = alignof(K) + alignof(V) + (2 * alignof(void *));
+
+    static constexpr std::size_t LEAF_ORDER = (NODE_SIZE - sizeof(Node) - (2 * sizeof(void *)) - SLACK) /
+            (sizeof(K) + sizeof(V));
+
+    static constexpr std::size_t INNER_ORDER = (NODE_SIZE - sizeof(Node) - sizeof(void *) - SLACK) /
+            (sizeof(K) + sizeof(void *));
+
+    static_assert(LEAF_ORDER >= 3, "NODE_SIZE is too small to hold 3 items per leaf.");
+    static_assert(INNER_ORDER >= 3, "NODE_SIZE is too small to hold 3 keys per inner node.");
+    static_assert(LEAF_ORDER < 65536, "NODE_SIZE is too big.");
+    static_assert(INNER_ORDER < 65536, "NODE_SIZE is too big.");
+
+    struct Leaf : Node {
+        K keys[LEAF_ORDER];
+        V values[LEAF_ORDER];
+        Leaf *previous;
+        Leaf *next;
+    };
+
+    struct Inner : Node {
+        K keys[INNER_ORDER];
+        Node *children[INNER_ORDER + 1];
+    };
+
+    static_assert(sizeof(Leaf) <= NODE_SIZE, "Leaf does not fit in NODE_SIZE.");
+    static_assert(sizeof(Inner) <= NODE_SIZE, "Inner node does not fit in NODE_SIZE.");
+};
+
+template <typename K, typename V, typename Tcomparator, std::size_t NODE_SIZE>
+class BTreeIterator {
+public:
+    BTreeIterator<K, V, Tcomparator, NODE_SIZE> &operator ++() {
+        if (_leaf != nullptr) {
+            ++_index;
+            if (_index == _leaf->count) {
+                _leaf = _leaf->next;
+                _index = 0;
+            }
+        }
+        return *this;
+    }
+
+    bool operator !=(const BTreeIterator<K, V, Tcomparator, NODE_SIZE> &other) const {
+        return (_leaf != other._leaf) || (_index != other._index);
+    }
+
+    const K &key() const {
+        return _leaf->keys[_index];
+    }
+
+    V &value() const {
+        return _leaf->values[_index];
+    }
+
+private:
+    typedef typename BTreeNodes<K, V, NODE_SIZE>::Leaf Leaf;
+
+    BTreeIterator(Leaf *leaf, std::size_t index) : _leaf(leaf), _index(index) {
+    }
+
+    Leaf *_leaf;
+    std::size_t _index;
+
+    friend class BTreeMap<K, V, Tcomparator, NODE_SIZE>;
+};
+
+/**
+ * @brief Ordered map implemented as a B+tree, with nodes sized to fit one block of a PoolAllocator.
+ *
+ * Keys are ordered by the comparator: a key a comes before b when compare(a, b) is positive, so a LessThanComparator
+ * gives ascending order. Tcomparator can be Comparator<K> to pick a comparator at runtime, or a concrete comparator
+ * type so the compiler can inline the comparisons. An abstract comparator type is kept by reference and the comparator
+ * must outlive the map, any other one is copied into it. All items are stored in the leaves, which are linked together
+ * so range queries are a scan along the leaves.
+ *
+ * Erasing does not merge nodes, a node is only released once it is empty. Inserts and bulkLoad take all nodes they
+ * might need from the allocator before changing the tree, so a failed allocation leaves the tree as it was.
+ */
+template <typename K, typename V, typename Tcomparator = Comparator<K>, std::size_t NODE_SIZE = 256>
+class BTreeMap {
+private:
+    typedef BTreeNodes<K, V, NODE_SIZE> Nodes;
+    typedef typename Nodes::Node Node;
+    typedef typename Nodes::Leaf Leaf;
+    typedef typename Nodes::Inner Inner;
+
+public:
+    typedef BTreeIterator<K, V, Tcomparator, NODE_SIZE> Iterator;
+
+    static constexpr std::size_t LEAF_ORDER = Nodes::LEAF_ORDER;
+    static constexpr std::size_t INNER_ORDER = Nodes::INNER_ORDER;
+
+    BTreeMap(Allocator &allocator, const Tcomparator &comparator) : _allocator(allocator), _comparator(comparator),
+            _root(nullptr), _first(nullptr), _size(0), _height(0), _spare(nullptr), _spareCount(0) {
+    }
+
+    ~BTreeMap() {
+        clear();
+    }
+
+    BTreeMap(const BTreeMap &) = delete;
+    BTreeMap &operator =(const BTreeMap &) = delete;
+
+    std::size_t size() const {
+        return _size;
+    }
+
+    bool empty() const {
+        return _size == 0;
+    }
+
+    V *find(const K &key) const {
+        Iterator it = lowerBound(key);
+        if ((it._leaf != nullptr) && (before(key, it.key()) == false)) {
+            return &it.value();
+        }
+        return nullptr;
+    }
+
+    bool contains(const K &key) const {
+        return find(key) != nullptr;
+    }
+
+    /**
+     * @brief Inserts a key or updates the value of a key that is already in the map.
+     *
+     * @return True on success, false if the allocator ran out of memory.
+     */
+    bool insert(const K &key, const V &value) {
+        V *existing = find(key);
+        if (existing != nullptr) {
+            *existing = value;
+            return true;
+        }
+
+        if (_root == nullptr) {
+            if (reserveNodes(1) == false) {
+                return false;
+            }
+            Leaf *leaf = makeLeaf();
+            _root = leaf;
+            _first = leaf;
+            _height = 1;
+        }
+
+        // Every full node on the path can split, and a full root needs a new root on top of that.
+        std::size_t needed = 0;
+        Node *node = _root;
+        for (;;) {
+            if (node->count == (node->leaf ? LEAF_ORDER : INNER_ORDER)) {
+                ++needed;
+            } else {
+                needed = 0;
+            }
+            if (node->leaf == true) {
+                break;
+            }
+            Inner *inner = static_cast<Inner *>(node);
+            node = inner->children[childIndex(inner, key)];
+        }
+        if ((needed != 0) && (needed == _height)) {
+            ++needed;
+        }
+
+        if (reserveNodes(needed) == false) {
+            return false;
+        }
+
+        K splitKey;
+        Node *splitNode = insert(_root, key, value, splitKey);
+        if (splitNode != nullptr) {
+            Inner *root = makeInner();
+            root->count = 1;
+            root->keys[0] = std::move(splitKey);
+            root->children[0] = _root;
+            root->children[1] = splitNode;
+            _root = root;
+            ++_height;
+        }
+
+        ++_size;
+
+        return true;
+    }
+
+    /**
+     * @brief Removes a key from the map.
+     *
+     * @return True if the key was in the map.
+     */
+    bool erase(const K &key) {
+        if (_root == nullptr) {
+            return false;
+        }
+
+        bool found = false;
+        if (erase(_root, key, found) == true) {
+            releaseNode(_root);
+            _root = nullptr;
+            _first = nullptr;
+            _height = 0;
+        }
+
+        // An inner root with a single child is not needed anymore.
+        while ((_root != nullptr) && (_root->leaf == false) && (_root->count == 0)) {
+            Node *child = static_cast<Inner *>(_root)->children[0];
+            releaseNode(_root);
+            _root = child;
+            --_height;
+        }
+
+        if (found == true) {
+            --_size;
+        }
+
+        return found;
+    }
+
+    void clear() {
+        if (_root != nullptr) {
+            clear(_root);
+        }
+        _root = nullptr;
+        _first = nullptr;
+        _size = 0;
+        _height = 0;
+        reserveNodes(0);
+    }
+
+    /**
+     * @brief Fills an empty map from keys that are sorted and unique according to the comparator.
+     *
+     * The leaves are filled completely and built bottom up, which is much faster than inserting one by one. Passing
+     * nullptr for values leaves all values default constructed.
+     *
+     * @return True on success, false if the map was not empty, the keys were not sorted or memory ran out.
+     */
+    bool bulkLoad(const K *keys, const V *values, std::size_t count) {
+        if (_root != nullptr) {
+            return false;
+        }
+
+        for (std::size_t i = 1; i < count; ++i) {
+            if (before(keys[i - 1], keys[i]) == false) {
+                return false;
+            }
+        }
+
+        if (count == 0) {
+            return true;
+        }
+
+        // Count the nodes of every level so all memory can be taken before building.
+        std::size_t nodes = (count + LEAF_ORDER - 1) / LEAF_ORDER;
+        std::size_t needed = nodes;
+        while (nodes > 1) {
+            nodes = (nodes + INNER_ORDER) / (INNER_ORDER + 1);
+            needed += nodes;
+        }
+
+        if (reserveNodes(needed) == false) {
+            reserveNodes(0);
+            return false;
+        }
+
+        // Per level, the first node that has no parent yet, the lowest key below it, and the parent being filled.
+        Node *pending[MAX_HEIGHT];
+        const K *pendingKeys[MAX_HEIGHT];
+        Inner *open[MAX_HEIGHT];
+        std::size_t height = 0;
+
+        Leaf *previous = nullptr;
+        for (std::size_t start = 0; start < count; start += LEAF_ORDER) {
+            Leaf *leaf = makeLeaf();
+            std::size_t end = ((count - start) < LEAF_ORDER) ? count : (start + LEAF_ORDER);
+            for (std::size_t i = start; i < end; ++i) {
+                leaf->keys[i - start] = keys[i];
+                if (values != nullptr) {
+                    leaf->values[i - start] = values[i];
+                }
+            }
+            leaf->count = static_cast<std::uint16_t>(end - start);
+
+            leaf->previous = previous;
+            if (previous != nullptr) {
+                previous->next = leaf;
+            } else {
+                _first = leaf;
+            }
+            previous = leaf;
+
+            // Hang the new node under the parent of its level, a new parent is in turn added one level up.
+            Node *child = leaf;
+            const K *childKey = &keys[start];
+            for (std::size_t level = 0; child != nullptr; ++level) {
+                if (level == height) {
+                    pending[level] = child;
+                    pendingKeys[level] = childKey;
+                    open[level] = nullptr;
+                    ++height;
+                    child = nullptr;
+                } else if (open[level] == nullptr) {
+                    Inner *parent = makeInner();
+                    parent->children[0] = pending[level];
+                    parent->keys[0] = *childKey;
+                    parent->children[1] = child;
+                    parent->count = 1;
+                    open[level] = parent;
+                    child = parent;
+                    childKey = pendingKeys[level];
+                } else if (open[level]->count < INNER_ORDER) {
+                    Inner *parent = open[level];
+                    parent->keys[parent->count] = *childKey;
+                    ++parent->count;
+                    parent->children[parent->count] = child;
+                    child = nullptr;
+                } else {
+                    Inner *parent = makeInner();
+                    parent->children[0] = child;
+                    open[level] = parent;
+                    child = parent;
+                }
+            }
+        }
+
+        _root = pending[height - 1];
+        _size = count;
+        _height = height;
+
+        return true;
+    }
+
+    Iterator begin() const {
+        return Iterator(_first, 0);
+    }
+
+    Iterator end() const {
+        return Iterator(nullptr, 0);
+    }
+
+    /**
+     * @brief Returns an iterator to the first key that does not come before key.
+     */
+    Iterator lowerBound(const K &key) const {
+        if (_root == nullptr) {
+            return end();
+        }
+
+        Node *node = _root;
+        while (node->leaf == false) {
+            Inner *inner = static_cast<Inner *>(node);
+            node = inner->children[childIndex(inner, key)];
+        }
+
+        Leaf *leaf = static_cast<Leaf *>(node);
+        std::size_t index = leafIndex(leaf, key);
+        if (index == leaf->count) {
+            return Iterator(leaf->next, 0);
+        }
+
+        return Iterator(leaf, index);
+    }
+
+    /**
+     * @brief Calls function(key, value) in order for every key from 'from' up to, but not including, 'to'.
+     *
+     * @return The number of items that were visited.
+     */
+    template <typename Tfunction>
+    std::size_t forEach(const K &from, const K &to, Tfunction function) const {
+        std::size_t visited = 0;
+        for (Iterator it = lowerBound(from); it != end(); ++it) {
+            if (before(it.key(), to) == false) {
+                break;
+            }
+            function(it.key(), it.value());
+            ++visited;
+        }
+        return visited;
+    }
+
+private:
+    // The spine used by bulkLoad is limited to this height, enough for any tree that fits in memory.
+    static constexpr std::size_t MAX_HEIGHT = 32;
+
+    bool before(const K &a, const K &b) const {
+        return _comparator.compare(a, b) > 0;
+    }
+
+    // Index of the child that holds key: the number of separator keys that do not come after key.
+    std::size_t childIndex(const Inner *inner, const K &key) const {
+        std::size_t low = 0;
+        std::size_t high = inner->count;
+        while (low < high) {
+            std::size_t mid = (low + high) / 2;
+            if (before(key, inner->keys[mid]) == true) {
+                high = mid;
+            } else {
+                low = mid + 1;
+            }
+        }
+        return low;
+    }
+
+    // Index of the first key in the leaf that does not come before key.
+    std::size_t leafIndex(const Leaf *leaf, const K &key) const {
+        std::size_t low = 0;
+        std::size_t high = leaf->count;
+        while (low < high) {
+            std::size_t mid = (low + high) / 2;
+            if (before(leaf->keys[mid], key) == true) {
+                low = mid + 1;
+            } else {
+                high = mid;
+            }
+        }
+        return low;
+    }
+
+    // Inserts into the subtree of node, returns the new right sibling if node had to split.
+    Node *insert(Node *node, const K &key, const V &value, K &splitKey) {
+        if (node->leaf == true) {
+            Leaf *leaf = static_cast<Leaf *>(node);
+            std::size_t index = leafIndex(leaf, key);
+
+            if (leaf->count < LEAF_ORDER) {
+                insertInLeaf(leaf, index, key, value);
+                return nullptr;
+            }
+
+            // Move the upper half to a new leaf and insert in the half the key belongs to.
+            Leaf *right = makeLeaf();
+            std::size_t half = LEAF_ORDER / 2;
+            for (std::size_t i = half; i < LEAF_ORDER; ++i) {
+                right->keys[i - half] = std::move(leaf->keys[i]);
+                right->values[i - half] = std::move(leaf->values[i]);
+            }
+            right->count = static_cast<std::uint16_t>(LEAF_ORDER - half);
+            leaf->count = static_cast<std::uint16_t>(half);
+
+            right->next = leaf->next;
+            right->previous = leaf;
+            if (leaf->next != nullptr) {
+                leaf->next->previous = right;
+            }
+            leaf->next = right;
+
+            if (index <= half) {
+                insertInLeaf(leaf, index, key, value);
+            } else {
+                insertInLeaf(right, index - half, key, value);
+            }
+
+            splitKey = right->keys[0];
+
+            return right;
+        }
+
+        Inner *inner = static_cast<Inner *>(node);
+        std::size_t index = childIndex(inner, key);
+
+        K childKey;
+        Node *childSplit = insert(inner->children[index], key, value, childKey);
+        if (childSplit == nullptr) {
+            return nullptr;
+        }
+
+        if (inner->count < INNER_ORDER) {
+            insertInInner(inner, index, childKey, childSplit);
+            return nullptr;
+        }
+
+        // Split as if the new key were already in place: the lower half stays, the middle key moves up to the parent.
+        Inner *right = makeInner();
+        std::size_t total = INNER_ORDER + 1;
+        std::size_t half = total / 2;
+
+        for (std::size_t i = half + 1; i < total; ++i) {
+            right->keys[i - half - 1] = std::move((i == index) ? childKey : inner->keys[(i < index) ? i : (i - 1)]);
+        }
+        for (std::size_t i = half + 1; i <= total; ++i) {
+            Node *child = (i == (index + 1)) ? childSplit : inner->children[(i <= index) ? i : (i - 1)];
+            right->children[i - half - 1] = child;
+        }
+        right->count = static_cast<std::uint16_t>(total - half - 1);
+
+        splitKey = std::move((half == index) ? childKey : inner->keys[(half < index) ? half : (half - 1)]);
+
+        if (index < half) {
+            inner->count = static_cast<std::uint16_t>(half - 1);
+            insertInInner(inner, index, childKey, childSplit);
+        } else {
+            inner->count = static_cast<std::uint16_t>(half);
+        }
+
+        return right;
+    }
+
+    void insertInLeaf(Leaf *leaf, std::size_t index, const K &key, const V &value) {
+        for (std::size_t i = leaf->count; i > index; --i) {
+            leaf->keys[i] = std::move(leaf->keys[i - 1]);
+            leaf->values[i] = std::move(leaf->values[i - 1]);
+        }
+        leaf->keys[index] = key;
+        leaf->values[index] = value;
+        ++leaf->count;
+    }
+
+    // Inserts key and the child to the right of it after child index.
+    void insertInInner(Inner *inner, std::size_t index, K &key, Node *child) {
+        for (std::size_t i = inner->count; i > index; --i) {
+            inner->keys[i] = std::move(inner->keys[i - 1]);
+            inner->children[i + 1] = inner->children[i];
+        }
+        inner->keys[index] = std::move(key);
+        inner->children[index + 1] = child;
+        ++inner->count;
+    }
+
+    // Erases key from the subtree of node, returns true if node is empty afterwards.
+    bool erase(Node *node, const K &key, bool &found) {
+        if (node->leaf == true) {
+            Leaf *leaf = static_cast<Leaf *>(node);
+            std::size_t index = leafIndex(leaf, key);
+            if ((index == leaf->count) || (before(key, leaf->keys[index]) == true)) {
+                return false;
+            }
+
+            found = true;
+            for (std::size_t i = index + 1; i < leaf->count; ++i) {
+                leaf->keys[i - 1] = std::move(leaf->keys[i]);
+                leaf->values[i - 1] = std::move(leaf->values[i]);
+            }
+            --leaf->count;
+
+            if (leaf->count != 0) {
+                return false;
+            }
+
+            // Take the empty leaf out of the chain of leaves.
+            if (leaf->previous != nullptr) {
+                leaf->previous->next = leaf->next;
+            } else {
+                _first = leaf->next;
+            }
+            if (leaf->next != nullptr) {
+                leaf->next->previous = leaf->previous;
+            }
+
+            return true;
+        }
+
+        Inner *inner = static_cast<Inner *>(node);
+        std::size_t index = childIndex(inner, key);
+        if (erase(inner->children[index], key, found) == false) {
+            return false;
+        }
+
+        releaseNode(inner->children[index]);
+
+        if (inner->count == 0) {
+            return true;
+        }
+
+        // Drop the empty child together with the separator key next to it.
+        std::size_t keyIndex = (index != 0) ? (index - 1) : 0;
+        for (std::size_t i = keyIndex + 1; i < inner->count; ++i) {
+            inner->keys[i - 1] = std::move(inner->keys[i]);
+        }
+        for (std::size_t i = index + 1; i <= inner->count; ++i) {
+            inner->children[i - 1] = inner->children[i];
+        }
+        --inner->count;
+
+        return false;
+    }
+
+    void clear(Node *node) {
+        if (node->leaf == false) {
+            Inner *inner = static_cast<Inner *>(node);
+            for (std::size_t i = 0; i <= inner->count; ++i) {
+                clear(inner->children[i]);
+            }
+        }
+        releaseNode(node);
+    }
+
+    // Makes sure n nodes are ready in the spare chain, n = 0 releases all of them.
+    bool reserveNodes(std::size_t n) {
+        while (_spareCount > n) {
+            void *mem = _spare;
+            _spare = *reinterpret_cast<void **>(mem);
+            --_spareCount;
+            _allocator.deallocate(mem);
+        }
+
+        while (_spareCount < n) {
+            void *mem = _allocator.allocate(NODE_SIZE);
+            if (mem == nullptr) {
+                return false;
+            }
+            *reinterpret_cast<void **>(mem) = _spare;
+            _spare = mem;
+            ++_spareCount;
+        }
+
+        return true;
+    }
+
+    void *takeNode() {
+        void *mem = _spare;
+        _spare = *reinterpret_cast<void **>(mem);
+        --_spareCount;
+        return mem;
+    }
+
+    Leaf *makeLeaf() {
+        Leaf *leaf = new (takeNode()) Leaf();
+        leaf->leaf = true;
+        leaf->count = 0;
+        leaf->previous = nullptr;
+        leaf->next = nullptr;
+        return leaf;
+    }
+
+    Inner *makeInner() {
+        Inner *inner = new (takeNode()) Inner();
+        inner->leaf = false;
+        inner->count = 0;
+        return inner;
+    }
+
+    void releaseNode(Node *node) {
+        if (node->leaf == true) {
+            static_cast<Leaf *>(node)->~Leaf();
+        } else {
+            static_cast<Inner *>(node)->~Inner();
+        }
+        _allocator.deallocate(node);
+    }
+
+    Allocator &_allocator;
+    typename ComparatorStorage<Tcomparator>::type _comparator;
+    Node *_root;
+    Leaf *_first;
+    std::size_t _size;
+    std::size_t _height;
+
+    // Nodes taken from the allocator up front by insert and bulkLoad, chained through their first word.
+    void *_spare;
+    std::size_t _spareCount;
+};
+
+// Placeholder value for BTreeSet.
+struct BTreeSetValue {
+};
+
+/**
+ * @brief Ordered set of keys, a BTreeMap without values.
+ */
+template <typename K, typename Tcomparator = Comparator<K>, std::size_t NODE_SIZE = 256>
+class BTreeSet {
+public:
+    typedef BTreeIterator<K, BTreeSetValue, Tcomparator, NODE_SIZE> Iterator;
+
+    BTreeSet(Allocator &allocator, const Tcomparator &comparator) : _map(allocator, comparator) {
+    }
+
+    std::size_t size() const {
+        return _map.size();
+    }
+
+    bool empty() const {
+        return _map.empty();
+    }
+
+    bool contains(const K &key) const {
+        return _map.contains(key);
+    }
+
+    /**
+     * @brief Adds a key to the set.
+     *
+     * @return True on success, false if the allocator ran out of memory.
+     */
+    bool insert(const K &key) {
+        return _map.insert(key, BTreeSetValue());
+    }
+
+    bool erase(const K &key) {
+        return _map.erase(key);
+    }
+
+    void clear() {
+        _map.clear();
+    }
+
+    bool bulkLoad(const K *keys, std::size_t count) {
+        return _map.bulkLoad(keys, nullptr, count);
+    }
+
+    Iterator begin() const {
+        return _map.begin();
+    }
+
+    Iterator end() const {
+        return _map.end();
+    }
+
+    Iterator lowerBound(const K &key) const {
+        return _map.lowerBound(key);
+    }
+
+    /**
+     * @brief Calls function(key) in order for every key from 'from' up to, but not including, 'to'.
+     *
+     * @return The number of keys that were visited.
+     */
+    template <typename Tfunction>
+    std::size_t forEach(const K &from, const K &to, Tfunction function) const {
+        return _map.forEach(from, to, [&function](const K &key, BTreeSetValue &) {
+            function(key);
+        });
+    }
+
+private:
+    BTreeMap<K, BTreeSetValue, Tcomparator, NODE_SIZE> _map;
+};
+
+} // ecpp
+
+#endif // BTREE_H
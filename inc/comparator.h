@@ -86,6 +86,19 @@ public:
     }
 };
 
+/**
+ * @brief The type a container keeps its comparator in.
+ *
+ * An abstract comparator type, such as the Comparator<T> interface, is kept by reference: the caller picks the
+ * implementation at runtime and must keep it alive as long as the container. Every other comparator type, including
+ * LessThanComparator and GreaterThanComparator, is copied into the container, so passing a temporary is fine.
+ */
+template <typename Tcomparator>
+struct ComparatorStorage {
+    typedef typename std::conditional<std::is_abstract<Tcomparator>::value, const Tcomparator &,
+            Tcomparator>::type type;
+};
+
 }
 
 #endif // COMPARATOR_H
@@ -0,0 +1,189 @@
+/*
+ * Copyright 2015 Erik Van Hamme
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef COMPILEDFRACTION_H
+#define COMPILEDFRACTION_H
+
+#include "fraction.h"
+#include "utils.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+namespace ecpp {
+
+/**
+ * @brief A Fraction prepared for scaling many values of type T without a hardware divide.
+ *
+ * The constructor turns the denominator into a magic multiplier and shift, the same way libdivide does for signed 64
+ * bit division. Scaling a value then forms value * num at 64 bits and divides it through a multiply-high, a few adds
+ * and a shift. The result is exactly value * num / den rounded towards 0, saturated to the range of T. A fraction
+ * with a denominator of 0 scales everything to 0.
+ */
+template <typename T>
+class CompiledFraction {
+public:
+
+    static_assert(std::is_integral<T>::value && (sizeof(T) <= 4), "Integral type of at most 32 bits required.");
+
+    template <typename Tnum, typename Tden>
+    explicit CompiledFraction(const Fraction<Tnum, Tden> &fraction) {
+        static_assert((sizeof(Tnum) <= 4) && (sizeof(Tden) <= 4), "Fraction parts of at most 32 bits required.");
+
+        // A reduced fraction has a positive denominator and the smallest possible numerator.
+        Fraction<std::int64_t, std::int64_t> reduced = Fraction<std::int64_t, std::int64_t>::make(fraction.getNum(),
+                fraction.getDen());
+
+        if (reduced.getDen() == 0) {
+            _num = 0;
+            setDivisor(1);
+        } else {
+            _num = reduced.getNum();
+            setDivisor(reduced.getDen());
+        }
+    }
+
+    T scale(T value) const {
+        return utils::saturate<T>(divide(static_cast<std::int64_t>(value) * _num));
+    }
+
+    /**
+     * @brief Scales count values from input into output, which may be the same array.
+     */
+    void scaleArray(const T *input, T *output, std::size_t count) const {
+        for (std::size_t i = 0; i < count; ++i) {
+            output[i] = scale(input[i]);
+        }
+    }
+
+private:
+    static constexpr std::uint8_t SHIFT_MASK = 0x3f;
+    static constexpr std::uint8_t ADD_MARKER = 0x40;
+    static constexpr std::uint8_t NEGATIVE_DIVISOR = 0x80;
+
+    // High 64 bits of the 128 bit product a * b.
+    static std::int64_t multiplyHigh(std::int64_t a, std::int64_t b) {
+#if defined(__SIZEOF_INT128__)
+        __extension__ typedef __int128 Wide;
+
+        return static_cast<std::int64_t>((static_cast<Wide>(a) * b) >> 64);
+#else
+        std::uint64_t ua = static_cast<std::uint64_t>(a);
+        std::uint64_t ub = static_cast<std::uint64_t>(b);
+        std::uint64_t p0 = (ua & 0xffffffffu) * (ub & 0xffffffffu);
+        std::uint64_t p1 = (ua & 0xffffffffu) * (ub >> 32);
+        std::uint64_t p2 = (ua >> 32) * (ub & 0xffffffffu);
+        std::uint64_t p3 = (ua >> 32) * (ub >> 32);
+        std::uint64_t middle = (p0 >> 32) + (p1 & 0xffffffffu) + (p2 & 0xffffffffu);
+        std::uint64_t high = p3 + (p1 >> 32) + (p2 >> 32) + (middle >> 32);
+
+        // Correct the unsigned product for negative operands.
+        if (a < 0) {
+            high -= ub;
+        }
+        if (b < 0) {
+            high -= ua;
+        }
+        return static_cast<std::int64_t>(high);
+#endif
+    }
+
+    // Quotient of the 128 bit number high:low by d, high must be less than d.
+    static std::uint64_t divideWide(std::uint64_t high, std::uint64_t low, std::uint64_t d, std::uint64_t &remainder) {
+        std::uint64_t quotient = 0;
+        for (int i = 0; i < 64; ++i) {
+            bool carry = (high >> 63) != 0;
+            high = (high << 1) | (low >> 63);
+            low <<= 1;
+            quotient <<= 1;
+            if ((carry == true) || (high >= d)) {
+                high -= d;
+                quotient |= 1;
+            }
+        }
+        remainder = high;
+        return quotient;
+    }
+
+    void setDivisor(std::int64_t d) {
+        std::uint64_t absD = (d < 0) ? (0 - static_cast<std::uint64_t>(d)) : static_cast<std::uint64_t>(d);
+        std::uint8_t floorLog2 = static_cast<std::uint8_t>(63 - utils::countLeadingZeros(absD));
+
+        if ((absD & (absD - 1)) == 0) {
+            // Powers of 2 only need a shift.
+            _magic = 0;
+            _more = static_cast<std::uint8_t>(floorLog2 | ((d < 0) ? NEGATIVE_DIVISOR : 0));
+            return;
+        }
+
+        // Start from 2^(63 + floorLog2) / |d| and take one more bit of precision if that is not enough.
+        std::uint64_t remainder;
+        std::uint64_t magic = divideWide(static_cast<std::uint64_t>(1) << (floorLog2 - 1), 0, absD, remainder);
+        std::uint64_t error = absD - remainder;
+
+        if (error < (static_cast<std::uint64_t>(1) << floorLog2)) {
+            _more = static_cast<std::uint8_t>(floorLog2 - 1);
+        } else {
+            magic += magic;
+            std::uint64_t twiceRemainder = remainder + remainder;
+            if ((twiceRemainder >= absD) || (twiceRemainder < remainder)) {
+                magic += 1;
+            }
+            _more = static_cast<std::uint8_t>(floorLog2 | ADD_MARKER);
+        }
+        magic += 1;
+
+        _magic = static_cast<std::int64_t>(magic);
+        if (d < 0) {
+            _more |= NEGATIVE_DIVISOR;
+            _magic = -_magic;
+        }
+    }
+
+    std::int64_t divide(std::int64_t numerator) const {
+        std::uint8_t shift = _more & SHIFT_MASK;
+
+        // All ones for a negative divisor, 0 otherwise.
+        std::int64_t sign = ((_more & NEGATIVE_DIVISOR) != 0) ? -1 : 0;
+
+        if (_magic == 0) {
+            // Round towards 0 by adding |d| - 1 to negative numerators before shifting.
+            std::uint64_t mask = (static_cast<std::uint64_t>(1) << shift) - 1;
+            std::uint64_t biased = static_cast<std::uint64_t>(numerator) + (static_cast<std::uint64_t>(numerator >> 63) &
+                    mask);
+            std::int64_t quotient = static_cast<std::int64_t>(biased) >> shift;
+            return (quotient ^ sign) - sign;
+        }
+
+        std::uint64_t quotient = static_cast<std::uint64_t>(multiplyHigh(_magic, numerator));
+        if ((_more & ADD_MARKER) != 0) {
+            quotient += (static_cast<std::uint64_t>(numerator) ^ static_cast<std::uint64_t>(sign)) -
+                    static_cast<std::uint64_t>(sign);
+        }
+
+        std::int64_t result = static_cast<std::int64_t>(quotient) >> shift;
+        return result + ((result < 0) ? 1 : 0);
+    }
+
+    std::int64_t _num;
+    std::int64_t _magic;
+    std::uint8_t _more;
+};
+
+} // ecpp
+
+#endif // COMPILEDFRACTION_H
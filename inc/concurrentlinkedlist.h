@@ -0,0 +1,392 @@
+/*
+ * Copyright 2015 Erik Van Hamme
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef CONCURRENTLINKEDLIST_H
+#define CONCURRENTLINKEDLIST_H
+
+#include "allocator.h"
+
+#include <atomic>
+#include <cassert>
+#include <cstddef>
+#include <new>
+
+namespace ecpp {
+
+// This prototype is required to make sure ConcurrentLinkedList can be used in the definition of ConcurrentLinkedListEntry.
+template <typename T, std::size_t MAX_READERS>
+class ConcurrentLinkedList;
+
+// This prototype is required to make sure ConcurrentLinkedListIterator can be used in the definition of ConcurrentLinkedListEntry.
+template <typename T, std::size_t MAX_READERS>
+class ConcurrentLinkedListIterator;
+
+template <typename T, std::size_t MAX_READERS>
+class ConcurrentLinkedListEntry {
+public:
+    ConcurrentLinkedListEntry(T item) : _item(item), _next(nullptr), _retiredNext(nullptr), _retiredEpoch(0) {
+    }
+
+private:
+    T _item;
+    std::atomic<ConcurrentLinkedListEntry *> _next;
+
+    // Only used by the writer once the entry is unlinked and waiting to be reclaimed.
+    ConcurrentLinkedListEntry *_retiredNext;
+    std::size_t _retiredEpoch;
+
+    friend class ConcurrentLinkedList<T, MAX_READERS>;
+    friend class ConcurrentLinkedListIterator<T, MAX_READERS>;
+};
+
+template <typename T, std::size_t MAX_READERS>
+class ConcurrentLinkedListIterator {
+public:
+    ConcurrentLinkedListIterator(ConcurrentLinkedListEntry<T, MAX_READERS> *entry) : _entry(entry) {
+    }
+
+    ConcurrentLinkedListIterator<T, MAX_READERS> &operator ++() {
+        if (_entry != nullptr) {
+            _entry = _entry->_next.load(std::memory_order_acquire);
+        }
+        return *this;
+    }
+
+    bool operator !=(const ConcurrentLinkedListIterator<T, MAX_READERS> &other) const {
+        return _entry != other._entry;
+    }
+
+    const T &operator *() const {
+        return _entry->_item;
+    }
+
+private:
+    ConcurrentLinkedListEntry<T, MAX_READERS> *_entry;
+};
+
+/**
+ * @brief Singly linked list for one writer thread and up to MAX_READERS reader threads.
+ *
+ * Readers traverse the list without taking locks while the writer inserts and removes items. A removed entry is not
+ * handed back to the allocator straight away: it is tagged with the current epoch and only reclaimed once every reader
+ * that could still be looking at it has left its read section.
+ *
+ * Each reader thread uses its own reader index in [0, MAX_READERS). All methods that are not part of ReadGuard must be
+ * called from the single writer thread.
+ */
+template <typename T, std::size_t MAX_READERS = 8>
+class ConcurrentLinkedList {
+public:
+
+    static_assert(MAX_READERS > 0, "At least one reader is required.");
+
+    /**
+     * @brief Read section of one reader, the entries of the list stay valid while the guard exists.
+     *
+     * Example:
+     *
+     *     ConcurrentLinkedList<int>::ReadGuard guard(list, readerIndex);
+     *     for (const int &item : guard) {
+     *         ...
+     *     }
+     */
+    class ReadGuard {
+    public:
+        ReadGuard(const ConcurrentLinkedList<T, MAX_READERS> &list, std::size_t reader) : _list(list), _reader(reader) {
+            _list.enter(_reader);
+        }
+
+        ~ReadGuard() {
+            _list.leave(_reader);
+        }
+
+        ReadGuard(const ReadGuard &) = delete;
+        ReadGuard &operator =(const ReadGuard &) = delete;
+
+        ConcurrentLinkedListIterator<T, MAX_READERS> begin() const {
+            return ConcurrentLinkedListIterator<T, MAX_READERS>(_list._head.load(std::memory_order_acquire));
+        }
+
+        ConcurrentLinkedListIterator<T, MAX_READERS> end() const {
+            return ConcurrentLinkedListIterator<T, MAX_READERS>(nullptr);
+        }
+
+    private:
+        const ConcurrentLinkedList<T, MAX_READERS> &_list;
+        std::size_t _reader;
+    };
+
+    ConcurrentLinkedList(Allocator &allocator) : _allocator(allocator), _head(nullptr), _tail(nullptr), _size(0),
+            _retired(nullptr), _retiredCount(0), _epoch(1) {
+        for (std::size_t i = 0; i < MAX_READERS; ++i) {
+            _readers[i].epoch.store(0, std::memory_order_relaxed);
+        }
+    }
+
+    // No reader may be inside a read section when the list is destroyed.
+    ~ConcurrentLinkedList() {
+        Entry *entry = _head.load(std::memory_order_relaxed);
+        while (entry != nullptr) {
+            Entry *next = entry->_next.load(std::memory_order_relaxed);
+            destroy(entry);
+            entry = next;
+        }
+
+        while (_retired != nullptr) {
+            Entry *next = _retired->_retiredNext;
+            destroy(_retired);
+            _retired = next;
+        }
+    }
+
+    ConcurrentLinkedList(const ConcurrentLinkedList &) = delete;
+    ConcurrentLinkedList &operator =(const ConcurrentLinkedList &) = delete;
+
+    std::size_t size() const {
+        return _size;
+    }
+
+    /**
+     * @brief Returns the number of removed entries that are still waiting to be reclaimed.
+     */
+    std::size_t retired() const {
+        return _retiredCount;
+    }
+
+    bool append(T item) {
+        Entry *newEntry = makeEntry(item);
+        if (newEntry == nullptr) {
+            return false;
+        }
+
+        // The entry is completely initialized before the release store makes it visible to the readers.
+        if (_tail != nullptr) {
+            _tail->_next.store(newEntry, std::memory_order_release);
+        } else {
+            _head.store(newEntry, std::memory_order_release);
+        }
+        _tail = newEntry;
+        ++_size;
+
+        return true;
+    }
+
+    bool prepend(T item) {
+        Entry *newEntry = makeEntry(item);
+        if (newEntry == nullptr) {
+            return false;
+        }
+
+        Entry *head = _head.load(std::memory_order_relaxed);
+        newEntry->_next.store(head, std::memory_order_relaxed);
+        _head.store(newEntry, std::memory_order_release);
+        if (_tail == nullptr) {
+            _tail = newEntry;
+        }
+        ++_size;
+
+        return true;
+    }
+
+    /**
+     * @brief Removes the first item that compares equal to item.
+     *
+     * @return True if an item was removed.
+     */
+    bool remove(const T &item) {
+        Entry *previous = nullptr;
+        Entry *entry = _head.load(std::memory_order_relaxed);
+
+        while (entry != nullptr) {
+            if (entry->_item == item) {
+                unlink(previous, entry);
+                reclaim();
+                return true;
+            }
+            previous = entry;
+            entry = entry->_next.load(std::memory_order_relaxed);
+        }
+
+        return false;
+    }
+
+    /**
+     * @brief Removes all items for which predicate returns true.
+     *
+     * @return The number of removed items.
+     */
+    template <typename Tpredicate>
+    std::size_t removeIf(Tpredicate predicate) {
+        std::size_t removed = 0;
+        Entry *previous = nullptr;
+        Entry *entry = _head.load(std::memory_order_relaxed);
+
+        while (entry != nullptr) {
+            Entry *next = entry->_next.load(std::memory_order_relaxed);
+            if (predicate(static_cast<const T &>(entry->_item)) == true) {
+                unlink(previous, entry);
+                ++removed;
+            } else {
+                previous = entry;
+            }
+            entry = next;
+        }
+
+        if (removed != 0) {
+            reclaim();
+        }
+
+        return removed;
+    }
+
+    void clear() {
+        Entry *entry = _head.load(std::memory_order_relaxed);
+        while (entry != nullptr) {
+            Entry *next = entry->_next.load(std::memory_order_relaxed);
+            unlink(nullptr, entry);
+            entry = next;
+        }
+        reclaim();
+    }
+
+    /**
+     * @brief Hands the removed entries that no reader can reach anymore back to the allocator.
+     *
+     * This is done automatically after every removal, calling it explicitly is only needed to release entries that
+     * were held up by a slow reader at the time of the removal.
+     *
+     * @return The number of entries that were reclaimed.
+     */
+    std::size_t reclaim() {
+
+        // Find the oldest epoch a reader is still working in.
+        std::size_t current = _epoch.load(std::memory_order_seq_cst);
+        std::size_t oldest = current;
+        for (std::size_t i = 0; i < MAX_READERS; ++i) {
+            std::size_t epoch = _readers[i].epoch.load(std::memory_order_seq_cst);
+            if ((epoch != 0) && (before(epoch, oldest) == true)) {
+                oldest = epoch;
+            }
+        }
+
+        // Entries retired before the oldest active epoch can no longer be reached by any reader.
+        std::size_t reclaimed = 0;
+        Entry **link = &_retired;
+        while (*link != nullptr) {
+            Entry *entry = *link;
+            if (before(entry->_retiredEpoch, oldest) == true) {
+                *link = entry->_retiredNext;
+                destroy(entry);
+                ++reclaimed;
+            } else {
+                link = &entry->_retiredNext;
+            }
+        }
+
+        _retiredCount -= reclaimed;
+
+        return reclaimed;
+    }
+
+private:
+    typedef ConcurrentLinkedListEntry<T, MAX_READERS> Entry;
+
+    // Each reader slot sits on its own cache line so readers do not slow each other down.
+    struct alignas(64) ReaderSlot {
+        std::atomic<std::size_t> epoch;
+    };
+
+    void enter(std::size_t reader) const {
+        assert(reader < MAX_READERS);
+
+        std::atomic<std::size_t> &slot = _readers[reader].epoch;
+        std::size_t epoch;
+
+        // Publish the epoch and check that the writer did not move on in between, otherwise the writer could have
+        // scanned the reader slots before this reader became visible.
+        do {
+            epoch = _epoch.load(std::memory_order_seq_cst);
+            slot.store(epoch, std::memory_order_seq_cst);
+        } while (_epoch.load(std::memory_order_seq_cst) != epoch);
+    }
+
+    void leave(std::size_t reader) const {
+        assert(reader < MAX_READERS);
+
+        _readers[reader].epoch.store(0, std::memory_order_release);
+    }
+
+    // Epochs wrap around, 0 is skipped because it marks an idle reader.
+    static bool before(std::size_t a, std::size_t b) {
+        return static_cast<std::ptrdiff_t>(a - b) < 0;
+    }
+
+    Entry *makeEntry(T item) {
+        void *mem = _allocator.allocate(sizeof(Entry));
+        if (mem == nullptr) {
+            return nullptr;
+        }
+        return new (mem) Entry(item);
+    }
+
+    void destroy(Entry *entry) {
+        entry->~Entry();
+        _allocator.deallocate(entry);
+    }
+
+    void unlink(Entry *previous, Entry *entry) {
+
+        // The next pointer of the removed entry is left intact, so readers standing on it can still move on.
+        Entry *next = entry->_next.load(std::memory_order_relaxed);
+        if (previous != nullptr) {
+            previous->_next.store(next, std::memory_order_release);
+        } else {
+            _head.store(next, std::memory_order_release);
+        }
+        if (_tail == entry) {
+            _tail = previous;
+        }
+        --_size;
+
+        // Retire the entry in the current epoch and start a new one. Readers that enter from now on cannot reach it.
+        std::size_t epoch = _epoch.load(std::memory_order_relaxed);
+        entry->_retiredEpoch = epoch;
+        entry->_retiredNext = _retired;
+        _retired = entry;
+        ++_retiredCount;
+
+        std::size_t nextEpoch = epoch + 1;
+        if (nextEpoch == 0) {
+            nextEpoch = 1;
+        }
+        _epoch.store(nextEpoch, std::memory_order_seq_cst);
+    }
+
+    Allocator &_allocator;
+    std::atomic<Entry *> _head;
+    Entry *_tail;
+    std::size_t _size;
+
+    Entry *_retired;
+    std::size_t _retiredCount;
+
+    alignas(64) std::atomic<std::size_t> _epoch;
+    mutable ReaderSlot _readers[MAX_READERS];
+};
+
+} // ecpp
+
+#endif // CONCURRENTLINKEDLIST_H
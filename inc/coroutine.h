@@ -0,0 +1,470 @@
+/*
+ * Copyright 2015 Erik Van Hamme
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef COROUTINE_H
+#define COROUTINE_H
+
+// Everything in here needs C++20 coroutines, with older standards the header is empty.
+#if defined(__cpp_impl_coroutine) && defined(__has_include)
+#if __has_include(<coroutine>)
+#define ECPP_HAVE_COROUTINES
+#endif
+#endif
+
+#ifdef ECPP_HAVE_COROUTINES
+
+#include "allocator.h"
+
+#include <coroutine>
+#include <cstddef>
+#include <exception>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace ecpp {
+
+/**
+ * @brief Makes allocator the allocator for coroutine frames created on this thread, until the scope ends.
+ *
+ * Scopes nest, the previous allocator is restored at the end of the scope. Without a scope, frames come from the
+ * global heap through the default Allocator.
+ */
+class FrameAllocatorScope {
+public:
+    explicit FrameAllocatorScope(Allocator &allocator) : _previous(current()) {
+        current() = &allocator;
+    }
+
+    ~FrameAllocatorScope() {
+        current() = _previous;
+    }
+
+    FrameAllocatorScope(const FrameAllocatorScope &) = delete;
+    FrameAllocatorScope &operator =(const FrameAllocatorScope &) = delete;
+
+    /**
+     * @brief Returns the allocator of the innermost scope on this thread, or nullptr.
+     */
+    static Allocator *&current() {
+        static thread_local Allocator *allocator = nullptr;
+        return allocator;
+    }
+
+private:
+    Allocator *_previous;
+};
+
+/**
+ * @brief Base for promise types that puts the coroutine frames in an ecpp Allocator.
+ *
+ * The frame comes from the allocator that is passed as std::allocator_arg, Allocator & as the first coroutine
+ * parameters (after the object for member functions), else from the FrameAllocatorScope of the thread. The
+ * allocator is remembered in front of the frame, so the frame can be destroyed on any thread.
+ *
+ * When the allocator runs out, operator new returns nullptr and the promise type must provide
+ * get_return_object_on_allocation_failure, as the promises of Task and Generator do.
+ */
+class FramePromise {
+public:
+    static void *operator new(std::size_t size) noexcept {
+        return allocate(size, FrameAllocatorScope::current());
+    }
+
+    template <typename... Targs>
+    static void *operator new(std::size_t size, std::allocator_arg_t, Allocator &allocator, Targs &...) noexcept {
+        return allocate(size, &allocator);
+    }
+
+    template <typename Tobject, typename... Targs>
+    static void *operator new(std::size_t size, Tobject &, std::allocator_arg_t, Allocator &allocator,
+            Targs &...) noexcept {
+        return allocate(size, &allocator);
+    }
+
+    static void operator delete(void *frame, std::size_t) noexcept {
+        if (frame == nullptr) {
+            return;
+        }
+
+        Header *header = static_cast<Header *>(frame) - 1;
+        header->allocator->deallocate(header);
+    }
+
+private:
+    // Keeps the frame after it at the alignment operator new guarantees.
+    struct alignas(alignof(std::max_align_t)) Header {
+        Allocator *allocator;
+    };
+
+    static Allocator &defaultAllocator() {
+        static Allocator allocator;
+        return allocator;
+    }
+
+    static void *allocate(std::size_t size, Allocator *allocator) noexcept {
+        if (allocator == nullptr) {
+            allocator = &defaultAllocator();
+        }
+
+        void *mem = allocator->allocate(sizeof(Header) + size);
+        if (mem == nullptr) {
+            return nullptr;
+        }
+
+        Header *header = new (mem) Header();
+        header->allocator = allocator;
+        return header + 1;
+    }
+};
+
+template <typename T>
+class Task;
+
+namespace coroutine {
+
+// Resumes the coroutine that awaits a finished task, if any.
+struct FinalAwaiter {
+    bool await_ready() const noexcept {
+        return false;
+    }
+
+    template <typename Tpromise>
+    std::coroutine_handle<> await_suspend(std::coroutine_handle<Tpromise> handle) const noexcept {
+        std::coroutine_handle<> continuation = handle.promise().continuation;
+        return (continuation != nullptr) ? continuation : std::noop_coroutine();
+    }
+
+    void await_resume() const noexcept {
+    }
+};
+
+template <typename T>
+class TaskPromiseBase : public FramePromise {
+public:
+    std::suspend_always initial_suspend() const noexcept {
+        return {};
+    }
+
+    FinalAwaiter final_suspend() const noexcept {
+        return {};
+    }
+
+    // ecpp code does not use exceptions.
+    void unhandled_exception() const noexcept {
+        std::terminate();
+    }
+
+    std::coroutine_handle<> continuation;
+};
+
+template <typename T>
+class TaskPromise : public TaskPromiseBase<T> {
+public:
+    Task<T> get_return_object() noexcept;
+
+    static Task<T> get_return_object_on_allocation_failure() noexcept;
+
+    template <typename Tvalue>
+    void return_value(Tvalue &&value) noexcept(std::is_nothrow_constructible<T, Tvalue &&>::value) {
+        new (&_value) T(std::forward<Tvalue>(value));
+        _hasValue = true;
+    }
+
+    ~TaskPromise() {
+        if (_hasValue == true) {
+            reinterpret_cast<T *>(&_value)->~T();
+        }
+    }
+
+    T &value() noexcept {
+        return *reinterpret_cast<T *>(&_value);
+    }
+
+    T take() noexcept(std::is_nothrow_move_constructible<T>::value) {
+        return std::move(value());
+    }
+
+private:
+    typename std::aligned_storage<sizeof(T), alignof(T)>::type _value;
+    bool _hasValue = false;
+};
+
+template <>
+class TaskPromise<void> : public TaskPromiseBase<void> {
+public:
+    Task<void> get_return_object() noexcept;
+
+    static Task<void> get_return_object_on_allocation_failure() noexcept;
+
+    void return_void() const noexcept {
+    }
+
+    void value() const noexcept {
+    }
+
+    void take() const noexcept {
+    }
+};
+
+} // coroutine
+
+/**
+ * @brief Lazily started coroutine that produces one value of type T, or nothing for void.
+ *
+ * The coroutine starts when the task is awaited, or when resume() is called by code that is not a coroutine, and the
+ * awaiting coroutine continues when it finishes. A task whose frame could not be allocated is invalid, awaiting it
+ * is not allowed.
+ */
+template <typename T = void>
+class Task {
+public:
+    typedef coroutine::TaskPromise<T> promise_type;
+
+    Task() noexcept : _handle(nullptr) {
+    }
+
+    explicit Task(std::coroutine_handle<promise_type> handle) noexcept : _handle(handle) {
+    }
+
+    Task(Task &&other) noexcept : _handle(other._handle) {
+        other._handle = nullptr;
+    }
+
+    Task &operator =(Task &&other) noexcept {
+        if (this != &other) {
+            destroy();
+            _handle = other._handle;
+            other._handle = nullptr;
+        }
+        return *this;
+    }
+
+    Task(const Task &) = delete;
+    Task &operator =(const Task &) = delete;
+
+    ~Task() {
+        destroy();
+    }
+
+    bool isValid() const noexcept {
+        return _handle != nullptr;
+    }
+
+    bool done() const noexcept {
+        return (_handle == nullptr) || _handle.done();
+    }
+
+    /**
+     * @brief Runs the coroutine until its next suspension point, for use outside of coroutines.
+     */
+    void resume() {
+        if (done() == false) {
+            _handle.resume();
+        }
+    }
+
+    /**
+     * @brief Returns the result of a finished task.
+     */
+    decltype(auto) result() {
+        return _handle.promise().value();
+    }
+
+    bool await_ready() const noexcept {
+        return done();
+    }
+
+    std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiting) noexcept {
+        _handle.promise().continuation = awaiting;
+        return _handle;
+    }
+
+    /**
+     * @brief Moves the result out of the task into the awaiting coroutine.
+     */
+    T await_resume() {
+        return _handle.promise().take();
+    }
+
+private:
+    void destroy() noexcept {
+        if (_handle != nullptr) {
+            _handle.destroy();
+            _handle = nullptr;
+        }
+    }
+
+    std::coroutine_handle<promise_type> _handle;
+};
+
+namespace coroutine {
+
+template <typename T>
+Task<T> TaskPromise<T>::get_return_object() noexcept {
+    return Task<T>(std::coroutine_handle<TaskPromise<T>>::from_promise(*this));
+}
+
+template <typename T>
+Task<T> TaskPromise<T>::get_return_object_on_allocation_failure() noexcept {
+    return Task<T>();
+}
+
+inline Task<void> TaskPromise<void>::get_return_object() noexcept {
+    return Task<void>(std::coroutine_handle<TaskPromise<void>>::from_promise(*this));
+}
+
+inline Task<void> TaskPromise<void>::get_return_object_on_allocation_failure() noexcept {
+    return Task<void>();
+}
+
+} // coroutine
+
+/**
+ * @brief Coroutine that produces a sequence of values with co_yield, iterated with a range for loop.
+ *
+ * The values are produced on demand: the coroutine runs up to the next co_yield each time the iterator advances.
+ */
+template <typename T>
+class Generator {
+public:
+    class promise_type : public FramePromise {
+    public:
+        Generator get_return_object() noexcept {
+            return Generator(std::coroutine_handle<promise_type>::from_promise(*this));
+        }
+
+        static Generator get_return_object_on_allocation_failure() noexcept {
+            return Generator();
+        }
+
+        std::suspend_always initial_suspend() const noexcept {
+            return {};
+        }
+
+        std::suspend_always final_suspend() const noexcept {
+            return {};
+        }
+
+        std::suspend_always yield_value(const T &value) noexcept {
+            _value = std::addressof(value);
+            return {};
+        }
+
+        void return_void() const noexcept {
+        }
+
+        void unhandled_exception() const noexcept {
+            std::terminate();
+        }
+
+        // Neither awaiting inside a generator nor co_return with a value is supported.
+        template <typename Tother>
+        std::suspend_never await_transform(Tother &&) = delete;
+
+        const T &value() const noexcept {
+            return *_value;
+        }
+
+    private:
+        // The yielded value lives in the suspended frame until the generator resumes.
+        const T *_value = nullptr;
+    };
+
+    class Iterator {
+    public:
+        explicit Iterator(std::coroutine_handle<promise_type> handle) noexcept : _handle(handle) {
+        }
+
+        const T &operator *() const noexcept {
+            return _handle.promise().value();
+        }
+
+        Iterator &operator ++() {
+            _handle.resume();
+            return *this;
+        }
+
+        bool operator !=(std::default_sentinel_t) const noexcept {
+            return (_handle != nullptr) && (_handle.done() == false);
+        }
+
+    private:
+        std::coroutine_handle<promise_type> _handle;
+    };
+
+    Generator() noexcept : _handle(nullptr) {
+    }
+
+    explicit Generator(std::coroutine_handle<promise_type> handle) noexcept : _handle(handle) {
+    }
+
+    Generator(Generator &&other) noexcept : _handle(other._handle) {
+        other._handle = nullptr;
+    }
+
+    Generator &operator =(Generator &&other) noexcept {
+        if (this != &other) {
+            destroy();
+            _handle = other._handle;
+            other._handle = nullptr;
+        }
+        return *this;
+    }
+
+    Generator(const Generator &) = delete;
+    Generator &operator =(const Generator &) = delete;
+
+    ~Generator() {
+        destroy();
+    }
+
+    bool isValid() const noexcept {
+        return _handle != nullptr;
+    }
+
+    /**
+     * @brief Runs the generator up to its first value, an invalid generator gives an empty sequence.
+     */
+    Iterator begin() {
+        if ((_handle != nullptr) && (_handle.done() == false)) {
+            _handle.resume();
+        }
+        return Iterator(_handle);
+    }
+
+    std::default_sentinel_t end() const noexcept {
+        return std::default_sentinel;
+    }
+
+private:
+    void destroy() noexcept {
+        if (_handle != nullptr) {
+            _handle.destroy();
+            _handle = nullptr;
+        }
+    }
+
+    std::coroutine_handle<promise_type> _handle;
+};
+
+} // ecpp
+
+#endif // ECPP_HAVE_COROUTINES
+
+#endif // COROUTINE_H
@@ -0,0 +1,152 @@
+/*
+ * Copyright 2015 Erik Van Hamme
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef CPUFEATURES_H
+#define CPUFEATURES_H
+
+#include "utils.h"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+// Defined when x86 kernels can be built for extensions beyond the compiler flags, with function target attributes.
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define ECPP_X86_DISPATCH
+#endif
+
+namespace ecpp {
+
+/**
+ * @brief Instruction set extensions that kernels can be specialised for.
+ */
+enum class CpuFeature : std::uint32_t {
+    NONE = 0x00,
+    SSE2 = 0x01,
+    SSSE3 = 0x02,
+    AVX2 = 0x04,
+    AVX512 = 0x08,
+    NEON = 0x10
+};
+
+template<>
+struct is_bitmask<CpuFeature> : std::true_type {};
+
+/**
+ * @brief Levels of vector support, a dispatched kernel runs the highest level that is not above the current one.
+ */
+enum class CpuLevel {
+    SCALAR,
+    SSE2,
+    SSSE3,
+    AVX2,
+    AVX512
+};
+
+static constexpr std::size_t CPU_LEVEL_COUNT = 5;
+
+class CpuFeatures {
+public:
+    CpuFeatures() = delete;
+
+    /**
+     * @brief Returns the extensions that the processor and operating system support, detected once on first use.
+     */
+    static CpuFeature features();
+
+    static bool has(CpuFeature feature);
+
+    /**
+     * @brief Returns the highest level the hardware supports.
+     */
+    static CpuLevel detectedLevel();
+
+    /**
+     * @brief Returns the level that dispatched kernels use: the detected level, or the forced level if that is lower.
+     */
+    static CpuLevel level();
+
+    /**
+     * @brief Limits all dispatched kernels to level, mainly to test the lower level kernels on capable hardware.
+     *
+     * A level above the detected one has no effect beyond the detected level.
+     */
+    static void forceLevel(CpuLevel level);
+
+    /**
+     * @brief Undoes forceLevel.
+     */
+    static void resetLevel();
+
+    /**
+     * @brief Returns a number that changes every time the level is forced or reset.
+     */
+    static unsigned int generation() {
+        return _generation.load(std::memory_order_acquire);
+    }
+
+private:
+    static std::atomic<unsigned int> _generation;
+    static std::atomic<int> _forcedLevel;
+};
+
+/**
+ * @brief Function pointer that is resolved once to the best kernel for the current CpuLevel.
+ *
+ * Kernels are given per level, nullptr for levels without a specialised kernel. The scalar kernel is required. The
+ * choice is made on the first call and again only after the level was forced or reset, other calls cost one atomic
+ * load and compare on top of the indirect call.
+ */
+template <typename Tfunction>
+class CpuDispatch {
+public:
+    CpuDispatch(Tfunction *scalar, Tfunction *sse2 = nullptr, Tfunction *ssse3 = nullptr, Tfunction *avx2 = nullptr,
+            Tfunction *avx512 = nullptr) : _function(scalar), _generation(0) {
+        _functions[static_cast<std::size_t>(CpuLevel::SCALAR)] = scalar;
+        _functions[static_cast<std::size_t>(CpuLevel::SSE2)] = sse2;
+        _functions[static_cast<std::size_t>(CpuLevel::SSSE3)] = ssse3;
+        _functions[static_cast<std::size_t>(CpuLevel::AVX2)] = avx2;
+        _functions[static_cast<std::size_t>(CpuLevel::AVX512)] = avx512;
+    }
+
+    CpuDispatch(const CpuDispatch &) = delete;
+    CpuDispatch &operator =(const CpuDispatch &) = delete;
+
+    Tfunction *get() {
+        unsigned int generation = CpuFeatures::generation();
+        if (_generation.load(std::memory_order_acquire) != generation) {
+            std::size_t index = static_cast<std::size_t>(CpuFeatures::level());
+            while ((index > 0) && (_functions[index] == nullptr)) {
+                --index;
+            }
+
+            // Racing threads all arrive at the same kernel, so a plain store is enough.
+            _function.store(_functions[index], std::memory_order_relaxed);
+            _generation.store(generation, std::memory_order_release);
+        }
+
+        return _function.load(std::memory_order_relaxed);
+    }
+
+private:
+    Tfunction *_functions[CPU_LEVEL_COUNT];
+    std::atomic<Tfunction *> _function;
+    std::atomic<unsigned int> _generation;
+};
+
+} // ecpp
+
+#endif // CPUFEATURES_H
@@ -21,10 +21,25 @@
 
 namespace ecpp {
 
+    /**
+     * @brief Order of the bytes of a multi-byte value in memory.
+     */
+    enum class ByteOrder {
+        LITTLE,
+        BIG
+    };
+
     struct Endian {
     private:
+#if defined(__BYTE_ORDER__)
+        static_assert(__BYTE_ORDER__ != __ORDER_PDP_ENDIAN__, "Middle endianness is not supported.");
+
+        // Converting the word itself would truncate its value, the byte order has to come from the compiler.
+        static constexpr std::uint8_t BYTE = (__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__) ? 0x04 : 0x01;
+#else
         static constexpr std::uint32_t WORD = 0x01020304;
         static constexpr std::uint8_t BYTE = static_cast<const std::uint8_t &> (WORD);
+#endif
 
         static_assert(BYTE != 0x02, "Middle endianness is not supported.");
         static_assert(BYTE != 0x03, "Middle endianness is not supported.");
@@ -36,6 +51,8 @@ namespace ecpp {
         static constexpr bool BIG = (BYTE == 0x01);
 
         static_assert(LITTLE || BIG, "Unknown endianness.");
+
+        static constexpr ByteOrder HOST = LITTLE ? ByteOrder::LITTLE : ByteOrder::BIG;
     };
 }
 
@@ -0,0 +1,239 @@
+/*
+ * Copyright 2015 Erik Van Hamme
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ENDIANTYPES_H
+#define ENDIANTYPES_H
+
+#include "endianness.h"
+#include "utils.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+namespace ecpp {
+
+/**
+ * @brief Converts values of type T between host order and ORDER.
+ *
+ * T can be any integer, enum or floating point type of 1, 2, 4 or 8 bytes. When ORDER is the host order, every
+ * conversion is a plain copy.
+ */
+template <typename T, ByteOrder ORDER>
+struct EndianConverter {
+    static_assert(std::is_arithmetic<T>::value || std::is_enum<T>::value, "Arithmetic or enum type required.");
+
+    static constexpr bool SWAP = (ORDER != Endian::HOST);
+
+    // Unsigned integer with the same size as T, the swap is done on this type.
+    typedef typename std::conditional<sizeof(T) == 1, std::uint8_t,
+            typename std::conditional<sizeof(T) == 2, std::uint16_t,
+            typename std::conditional<sizeof(T) == 4, std::uint32_t, std::uint64_t>::type>::type>::type Bits;
+
+    static_assert(sizeof(Bits) == sizeof(T), "Only types of 1, 2, 4 or 8 bytes are supported.");
+
+    /**
+     * @brief Reads a value stored in ORDER from memory with any alignment.
+     */
+    static T load(const void *source) {
+        Bits bits;
+        std::memcpy(&bits, source, sizeof(bits));
+        if (SWAP) {
+            bits = utils::byteSwapped(bits);
+        }
+        T value;
+        std::memcpy(&value, &bits, sizeof(value));
+        return value;
+    }
+
+    /**
+     * @brief Writes value in ORDER to memory with any alignment.
+     */
+    static void store(void *destination, T value) {
+        Bits bits;
+        std::memcpy(&bits, &value, sizeof(bits));
+        if (SWAP) {
+            bits = utils::byteSwapped(bits);
+        }
+        std::memcpy(destination, &bits, sizeof(bits));
+    }
+
+    /**
+     * @brief Reads count consecutive values stored in ORDER, converting them with the bulk byte swap.
+     */
+    static void load(T *destination, const void *source, std::size_t count) {
+        std::memcpy(destination, source, count * sizeof(T));
+        if (SWAP) {
+            swapArray(reinterpret_cast<Bits *>(destination), count);
+        }
+    }
+
+    /**
+     * @brief Writes count consecutive values in ORDER. The source values are left untouched.
+     */
+    static void store(void *destination, const T *source, std::size_t count) {
+        std::memcpy(destination, source, count * sizeof(T));
+        if (SWAP) {
+            swapArray(static_cast<Bits *>(destination), count);
+        }
+    }
+
+private:
+    static void swapArray(std::uint8_t *data, std::size_t count) {
+        (void) data;
+        (void) count;
+    }
+
+    template <typename Tbits>
+    static void swapArray(Tbits *data, std::size_t count) {
+        utils::byteSwapArray(data, count);
+    }
+};
+
+/**
+ * @brief Value of type T that is stored in memory in ORDER, regardless of the host order.
+ *
+ * The value is kept as raw bytes, so it has an alignment of 1 and no padding. Structs made of these types can be
+ * overlaid directly on a received buffer, every field is converted only when it is accessed.
+ */
+template <typename T, ByteOrder ORDER>
+class EndianValue {
+public:
+    EndianValue() = default;
+
+    EndianValue(T value) {
+        EndianConverter<T, ORDER>::store(_bytes, value);
+    }
+
+    EndianValue &operator =(T value) {
+        EndianConverter<T, ORDER>::store(_bytes, value);
+        return *this;
+    }
+
+    T get() const {
+        return EndianConverter<T, ORDER>::load(_bytes);
+    }
+
+    operator T() const {
+        return get();
+    }
+
+private:
+    std::uint8_t _bytes[sizeof(T)];
+};
+
+template <typename T>
+using BigEndian = EndianValue<T, ByteOrder::BIG>;
+
+template <typename T>
+using LittleEndian = EndianValue<T, ByteOrder::LITTLE>;
+
+/**
+ * @brief Read-only array of count values of type T stored in ORDER in a raw buffer, converted on access.
+ *
+ * The view does not own the buffer, which can have any alignment.
+ */
+template <typename T, ByteOrder ORDER>
+class ConstEndianSpan {
+public:
+    ConstEndianSpan(const void *data, std::size_t count) : _data(static_cast<const std::uint8_t *>(data)),
+            _count(count) {
+    }
+
+    std::size_t size() const {
+        return _count;
+    }
+
+    const void *data() const {
+        return _data;
+    }
+
+    T operator [](std::size_t pos) const {
+        return EndianConverter<T, ORDER>::load(_data + (pos * sizeof(T)));
+    }
+
+    /**
+     * @brief Converts count values starting at first into destination.
+     *
+     * @return The number of values that were converted, limited by the end of the view.
+     */
+    std::size_t load(T *destination, std::size_t first, std::size_t count) const {
+        if (first >= _count) {
+            return 0;
+        }
+        if (count > (_count - first)) {
+            count = _count - first;
+        }
+        EndianConverter<T, ORDER>::load(destination, _data + (first * sizeof(T)), count);
+        return count;
+    }
+
+protected:
+    const std::uint8_t *_data;
+    std::size_t _count;
+};
+
+/**
+ * @brief Array of count values of type T stored in ORDER in a raw buffer, converted on access.
+ */
+template <typename T, ByteOrder ORDER>
+class EndianSpan : public ConstEndianSpan<T, ORDER> {
+public:
+    EndianSpan(void *data, std::size_t count) : ConstEndianSpan<T, ORDER>(data, count) {
+    }
+
+    void set(std::size_t pos, T value) {
+        EndianConverter<T, ORDER>::store(writableData() + (pos * sizeof(T)), value);
+    }
+
+    /**
+     * @brief Converts count values from source into the view, starting at first.
+     *
+     * @return The number of values that were stored, limited by the end of the view.
+     */
+    std::size_t store(const T *source, std::size_t first, std::size_t count) {
+        if (first >= this->_count) {
+            return 0;
+        }
+        if (count > (this->_count - first)) {
+            count = this->_count - first;
+        }
+        EndianConverter<T, ORDER>::store(writableData() + (first * sizeof(T)), source, count);
+        return count;
+    }
+
+private:
+    std::uint8_t *writableData() {
+        return const_cast<std::uint8_t *>(this->_data);
+    }
+};
+
+template <typename T>
+using BigEndianSpan = EndianSpan<T, ByteOrder::BIG>;
+
+template <typename T>
+using LittleEndianSpan = EndianSpan<T, ByteOrder::LITTLE>;
+
+template <typename T>
+using ConstBigEndianSpan = ConstEndianSpan<T, ByteOrder::BIG>;
+
+template <typename T>
+using ConstLittleEndianSpan = ConstEndianSpan<T, ByteOrder::LITTLE>;
+
+} // ecpp
+
+#endif // ENDIANTYPES_H
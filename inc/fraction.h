@@ -17,10 +17,41 @@
 #ifndef FRACTION
 #define FRACTION
 
+#include <cstdint>
 #include <type_traits>
 
 namespace ecpp {
 
+    namespace fraction {
+
+        template <typename T>
+        constexpr std::intmax_t wide(T value) {
+            return static_cast<std::intmax_t>(value);
+        }
+
+        constexpr std::intmax_t absolute(std::intmax_t value) {
+            return (value < 0) ? -value : value;
+        }
+
+        constexpr std::intmax_t gcd(std::intmax_t a, std::intmax_t b) {
+            return (b == 0) ? absolute(a) : gcd(b, a % b);
+        }
+
+        // Greatest common divisor that is safe to divide by, 1 when both are 0.
+        constexpr std::intmax_t reducer(std::intmax_t a, std::intmax_t b) {
+            return (gcd(a, b) == 0) ? 1 : gcd(a, b);
+        }
+
+        // Divisor that reduces num / den and makes den positive.
+        constexpr std::intmax_t normalizer(std::intmax_t num, std::intmax_t den) {
+            return (den < 0) ? -reducer(num, den) : reducer(num, den);
+        }
+
+        constexpr int order(std::intmax_t a, std::intmax_t b) {
+            return (a < b) ? -1 : ((b < a) ? 1 : 0);
+        }
+    }
+
     template <typename Tnum = int, typename Tden = int>
     class Fraction {
     public:
@@ -28,56 +59,170 @@ namespace ecpp {
         static_assert(std::is_integral<Tnum>::value, "Tnum should be integral type.");
         static_assert(std::is_integral<Tden>::value, "Tden should be integral type.");
 
-        Fraction() : _num(0), _den(0) {
+        constexpr Fraction() : _num(0), _den(0) {
         }
 
         constexpr Fraction(Tnum num, Tden den) : _num(num), _den(den) {
         }
 
-        constexpr Tnum getNum() {
+        constexpr Tnum getNum() const {
             return _num;
         }
 
-        constexpr Tden getDen() {
+        constexpr Tden getDen() const {
             return _den;
         }
 
-        // TODO: Implement math operators for Fraction / Fraction operations.
+        /**
+         * @brief Returns the same value divided by the greatest common divisor, with a positive denominator.
+         */
+        constexpr Fraction normalized() const {
+            return make(_num, _den);
+        }
+
+        /**
+         * @brief Builds a normalized fraction from wide intermediates.
+         *
+         * All arithmetic goes through intmax_t, so products of two int sized parts can not overflow. The result has
+         * to fit in Tnum and Tden after reduction.
+         */
+        static constexpr Fraction make(std::intmax_t num, std::intmax_t den) {
+            return Fraction(static_cast<Tnum>(num / fraction::normalizer(num, den)),
+                    static_cast<Tden>(den / fraction::normalizer(num, den)));
+        }
+
+        Fraction &operator +=(const Fraction &other) {
+            return *this = *this + other;
+        }
+
+        Fraction &operator -=(const Fraction &other) {
+            return *this = *this - other;
+        }
+
+        Fraction &operator *=(const Fraction &other) {
+            return *this = *this * other;
+        }
+
+        Fraction &operator /=(const Fraction &other) {
+            return *this = *this / other;
+        }
 
     private:
         Tnum _num;
         Tden _den;
     };
 
+    template <typename Tnum, typename Tden>
+    constexpr Fraction<Tnum, Tden> operator -(const Fraction<Tnum, Tden> &a) {
+        static_assert(std::is_signed<Tnum>::value, "Negating a fraction with an unsigned numerator.");
+
+        return Fraction<Tnum, Tden>::make(-fraction::wide(a.getNum()), fraction::wide(a.getDen()));
+    }
+
+    // The sum is formed over the least common multiple of the denominators.
+    template <typename Tnum, typename Tden>
+    constexpr Fraction<Tnum, Tden> operator +(const Fraction<Tnum, Tden> &a, const Fraction<Tnum, Tden> &b) {
+        return Fraction<Tnum, Tden>::make(
+                (fraction::wide(a.getNum()) * (fraction::wide(b.getDen()) / fraction::reducer(a.getDen(), b.getDen()))) +
+                (fraction::wide(b.getNum()) * (fraction::wide(a.getDen()) / fraction::reducer(a.getDen(), b.getDen()))),
+                fraction::wide(a.getDen()) * (fraction::wide(b.getDen()) / fraction::reducer(a.getDen(), b.getDen())));
+    }
+
+    // Formed like the sum rather than as a + (-b), so unsigned fractions can subtract as long as the result fits.
+    template <typename Tnum, typename Tden>
+    constexpr Fraction<Tnum, Tden> operator -(const Fraction<Tnum, Tden> &a, const Fraction<Tnum, Tden> &b) {
+        return Fraction<Tnum, Tden>::make(
+                (fraction::wide(a.getNum()) * (fraction::wide(b.getDen()) / fraction::reducer(a.getDen(), b.getDen()))) -
+                (fraction::wide(b.getNum()) * (fraction::wide(a.getDen()) / fraction::reducer(a.getDen(), b.getDen()))),
+                fraction::wide(a.getDen()) * (fraction::wide(b.getDen()) / fraction::reducer(a.getDen(), b.getDen())));
+    }
+
+    // Both cross pairs are reduced before multiplying, which keeps the intermediates as small as possible.
+    template <typename Tnum, typename Tden>
+    constexpr Fraction<Tnum, Tden> operator *(const Fraction<Tnum, Tden> &a, const Fraction<Tnum, Tden> &b) {
+        return Fraction<Tnum, Tden>::make(
+                (fraction::wide(a.getNum()) / fraction::reducer(a.getNum(), b.getDen())) *
+                (fraction::wide(b.getNum()) / fraction::reducer(b.getNum(), a.getDen())),
+                (fraction::wide(a.getDen()) / fraction::reducer(b.getNum(), a.getDen())) *
+                (fraction::wide(b.getDen()) / fraction::reducer(a.getNum(), b.getDen())));
+    }
+
+    template <typename Tnum, typename Tden>
+    constexpr Fraction<Tnum, Tden> operator /(const Fraction<Tnum, Tden> &a, const Fraction<Tnum, Tden> &b) {
+        return a * Fraction<Tnum, Tden>::make(b.getDen(), b.getNum());
+    }
+
+    namespace fraction {
+
+        /**
+         * @brief Returns -1, 0 or 1 when a is less than, equal to or greater than b, by cross multiplying.
+         */
+        template <typename Tnum, typename Tden>
+        constexpr int compare(const Fraction<Tnum, Tden> &a, const Fraction<Tnum, Tden> &b) {
+            return order(wide(a.getNum()) * wide(b.getDen()), wide(b.getNum()) * wide(a.getDen())) *
+                    (((a.getDen() < 0) != (b.getDen() < 0)) ? -1 : 1);
+        }
+    }
+
+    template <typename Tnum, typename Tden>
+    constexpr bool operator ==(const Fraction<Tnum, Tden> &a, const Fraction<Tnum, Tden> &b) {
+        return fraction::compare(a, b) == 0;
+    }
+
+    template <typename Tnum, typename Tden>
+    constexpr bool operator !=(const Fraction<Tnum, Tden> &a, const Fraction<Tnum, Tden> &b) {
+        return fraction::compare(a, b) != 0;
+    }
+
+    template <typename Tnum, typename Tden>
+    constexpr bool operator <(const Fraction<Tnum, Tden> &a, const Fraction<Tnum, Tden> &b) {
+        return fraction::compare(a, b) < 0;
+    }
+
+    template <typename Tnum, typename Tden>
+    constexpr bool operator >(const Fraction<Tnum, Tden> &a, const Fraction<Tnum, Tden> &b) {
+        return fraction::compare(a, b) > 0;
+    }
+
+    template <typename Tnum, typename Tden>
+    constexpr bool operator <=(const Fraction<Tnum, Tden> &a, const Fraction<Tnum, Tden> &b) {
+        return fraction::compare(a, b) <= 0;
+    }
+
+    template <typename Tnum, typename Tden>
+    constexpr bool operator >=(const Fraction<Tnum, Tden> &a, const Fraction<Tnum, Tden> &b) {
+        return fraction::compare(a, b) >= 0;
+    }
+
+    // The scalar operators only take part in overload resolution for arithmetic types, so they do not compete with the
+    // fraction operators above.
     template <typename T, typename Tnum, typename Tden>
-    constexpr T operator *(const T &a, const Fraction<Tnum, Tden> &b) {
+    constexpr typename std::enable_if<std::is_arithmetic<T>::value, T>::type operator *(const T &a,
+            const Fraction<Tnum, Tden> &b) {
 
-        static_assert(std::is_arithmetic<T>::value, "Arithmetic type needed.");
         static_assert(std::is_signed<T>::value == std::is_signed<Fraction<Tnum, Tden>>::value, "Signed mixed with unsigned.");
 
         return (a * static_cast<T> (b.getNum())) / static_cast<T> (b.getDen());
     }
 
     template <typename T, typename Tnum, typename Tden>
-    constexpr T operator *(const Fraction<Tnum, Tden> &a, const T &b) {
+    constexpr typename std::enable_if<std::is_arithmetic<T>::value, T>::type operator *(const Fraction<Tnum, Tden> &a,
+            const T &b) {
 
-        static_assert(std::is_arithmetic<T>::value, "Arithmetic type needed.");
         static_assert(std::is_signed<T>::value == std::is_signed<Fraction<Tnum, Tden>>::value, "Signed mixed with unsigned.");
 
         return (b * static_cast<T> (a.getNum())) / static_cast<T> (a.getDen());
     }
 
     template <typename T, typename Tnum, typename Tden>
-    constexpr T operator /(const T &a, const Fraction<Tnum, Tden> &b) {
+    constexpr typename std::enable_if<std::is_arithmetic<T>::value, T>::type operator /(const T &a,
+            const Fraction<Tnum, Tden> &b) {
 
-        static_assert(std::is_arithmetic<T>::value, "Arithmetic type needed.");
         static_assert(std::is_signed<T>::value == std::is_signed<Fraction<Tnum, Tden>>::value, "Signed mixed with unsigned.");
 
         return (a * static_cast<T> (b.getDen())) / static_cast<T> (b.getNum());
     }
 
-    // TODO: Implement other basic math operators, (Addition, Subtraction) return type will be Fraction<Tnum, Tden>.
-
     template <typename>
     struct is_fraction : std::false_type {};
 
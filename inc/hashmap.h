@@ -0,0 +1,451 @@
+/*
+ * Copyright 2015 Erik Van Hamme
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef HASHMAP_H
+#define HASHMAP_H
+
+#include "allocator.h"
+#include "utils.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <limits>
+#include <new>
+#include <utility>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace ecpp {
+
+/**
+ * @brief Control bytes of a HashMap slot.
+ *
+ * A full slot holds the low 7 bits of the hash of its key, so the high bit tells full slots apart from free ones.
+ */
+struct HashMapControl {
+    static constexpr std::int8_t EMPTY = -128;
+    static constexpr std::int8_t DELETED = -2;
+
+    HashMapControl() = delete;
+};
+
+/**
+ * @brief Set of matching slots within a group, iterated from the lowest slot up.
+ */
+class HashMapMatch {
+public:
+    constexpr HashMapMatch(std::uint32_t mask) : _mask(mask) {
+    }
+
+    constexpr bool any() const {
+        return _mask != 0;
+    }
+
+    std::size_t lowest() const {
+        return static_cast<std::size_t>(utils::bitPosition(_mask));
+    }
+
+    void next() {
+        _mask &= (_mask - 1u);
+    }
+
+private:
+    std::uint32_t _mask;
+};
+
+#if defined(__SSE2__)
+
+/**
+ * @brief Group of 16 control bytes that is probed with SSE2 compares.
+ */
+class HashMapGroup {
+public:
+    static constexpr std::size_t WIDTH = 16;
+
+    explicit HashMapGroup(const std::int8_t *ctrl) : _ctrl(_mm_loadu_si128(reinterpret_cast<const __m128i *>(ctrl))) {
+    }
+
+    HashMapMatch match(std::int8_t h2) const {
+        return HashMapMatch(static_cast<std::uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_set1_epi8(h2), _ctrl))));
+    }
+
+    HashMapMatch matchEmpty() const {
+        return match(HashMapControl::EMPTY);
+    }
+
+    HashMapMatch matchEmptyOrDeleted() const {
+        // Both EMPTY and DELETED are below -1, full slots are 0 or above.
+        return HashMapMatch(static_cast<std::uint32_t>(_mm_movemask_epi8(_mm_cmpgt_epi8(_mm_set1_epi8(-1), _ctrl))));
+    }
+
+private:
+    __m128i _ctrl;
+};
+
+#else
+
+/**
+ * @brief Group of 8 control bytes that is probed with 64-bit word operations.
+ */
+class HashMapGroup {
+public:
+    static constexpr std::size_t WIDTH = 8;
+
+    // Byte i of the group ends up in the i-th byte of the word counting from the least significant one, on both
+    // little and big endian targets. Compilers turn this into a single load on little endian targets.
+    explicit HashMapGroup(const std::int8_t *ctrl) : _ctrl(0) {
+        for (std::size_t i = 0; i < WIDTH; ++i) {
+            _ctrl |= static_cast<std::uint64_t>(static_cast<std::uint8_t>(ctrl[i])) << (8 * i);
+        }
+    }
+
+    // This can report a false positive next to a true match, which is harmless because keys are compared anyway.
+    HashMapMatch match(std::int8_t h2) const {
+        std::uint64_t x = _ctrl ^ (LSBS * static_cast<std::uint8_t>(h2));
+        return compress((x - LSBS) & ~x & MSBS);
+    }
+
+    HashMapMatch matchEmpty() const {
+        // EMPTY is the only control byte with the high bit set and bit 1 cleared.
+        return compress(_ctrl & ~(_ctrl << 6) & MSBS);
+    }
+
+    HashMapMatch matchEmptyOrDeleted() const {
+        // EMPTY and DELETED are the only control bytes with the high bit set and bit 0 cleared.
+        return compress(_ctrl & ~(_ctrl << 7) & MSBS);
+    }
+
+private:
+    static constexpr std::uint64_t LSBS = 0x0101010101010101ull;
+    static constexpr std::uint64_t MSBS = 0x8080808080808080ull;
+
+    // Gathers the high bit of every byte into an 8-bit mask.
+    static HashMapMatch compress(std::uint64_t bytes) {
+        return HashMapMatch(static_cast<std::uint32_t>(((bytes >> 7) * 0x0102040810204080ull) >> 56));
+    }
+
+    std::uint64_t _ctrl;
+};
+
+#endif
+
+/**
+ * @brief Fixed capacity hash map with open addressing.
+ *
+ * The slots are organized as in a SwissTable: every slot has a control byte with 7 bits of the hash of its key, and a
+ * whole group of control bytes is matched at once (with SSE2 when available). Slots and control bytes are allocated
+ * in one block when the map is constructed. The map never rehashes into a bigger table, an insert fails when the map
+ * holds capacity items.
+ *
+ * If the allocator cannot provide the memory, the map ends up with a capacity of 0 and every insert fails.
+ */
+template <typename K, typename V, typename Thash = std::hash<K>>
+class HashMap {
+public:
+    HashMap(Allocator &allocator, std::size_t capacity, const Thash &hash = Thash()) : _allocator(allocator),
+            _hash(hash), _slots(nullptr), _ctrl(nullptr), _capacity(0), _groupMask(0), _size(0), _deleted(0) {
+
+        if (capacity == 0) {
+            return;
+        }
+
+        // A full map uses at most 3/4 of the slots, which leaves room for at least 1/8 of the slots in tombstones
+        // between two purges.
+        std::size_t slotCount = HashMapGroup::WIDTH;
+        while (((slotCount / 4) * 3) < capacity) {
+            slotCount *= 2;
+        }
+
+        void *mem = _allocator.allocate((sizeof(Slot) * slotCount) + slotCount);
+        if (mem == nullptr) {
+            return;
+        }
+
+        _slots = static_cast<Slot *>(mem);
+        _ctrl = reinterpret_cast<std::int8_t *>(_slots + slotCount);
+        _capacity = capacity;
+        _groupMask = (slotCount / HashMapGroup::WIDTH) - 1;
+
+        std::memset(_ctrl, HashMapControl::EMPTY, slotCount);
+    }
+
+    ~HashMap() {
+        if (_slots != nullptr) {
+            clear();
+            _allocator.deallocate(_slots);
+        }
+    }
+
+    HashMap(const HashMap &) = delete;
+    HashMap &operator =(const HashMap &) = delete;
+
+    std::size_t capacity() const {
+        return _capacity;
+    }
+
+    std::size_t size() const {
+        return _size;
+    }
+
+    bool empty() const {
+        return _size == 0;
+    }
+
+    /**
+     * @brief Looks up a key.
+     *
+     * @return Pointer to the value, or nullptr if the key is not in the map. The pointer stays valid until the key is
+     *         erased.
+     */
+    V *find(const K &key) {
+        std::size_t slot = lookup(key);
+        return (slot != NOT_FOUND) ? &_slots[slot].value : nullptr;
+    }
+
+    const V *find(const K &key) const {
+        std::size_t slot = lookup(key);
+        return (slot != NOT_FOUND) ? &_slots[slot].value : nullptr;
+    }
+
+    bool contains(const K &key) const {
+        return lookup(key) != NOT_FOUND;
+    }
+
+    /**
+     * @brief Inserts a key or updates the value of a key that is already in the map.
+     *
+     * @return True on success, false if the map is full.
+     */
+    bool insert(const K &key, const V &value) {
+        std::size_t hash = hashOf(key);
+
+        std::size_t slot = lookup(key, hash);
+        if (slot != NOT_FOUND) {
+            _slots[slot].value = value;
+            return true;
+        }
+
+        if (_size == _capacity) {
+            return false;
+        }
+
+        // Too many tombstones make misses probe long sequences, clean them up instead of growing.
+        if ((_size + _deleted) >= maxLoad()) {
+            purgeDeleted();
+        }
+
+        slot = findFree(hash);
+        if (_ctrl[slot] == HashMapControl::DELETED) {
+            --_deleted;
+        }
+
+        new (&_slots[slot]) Slot(key, value);
+        _ctrl[slot] = h2(hash);
+        ++_size;
+
+        return true;
+    }
+
+    /**
+     * @brief Removes a key from the map.
+     *
+     * @return True if the key was in the map.
+     */
+    bool erase(const K &key) {
+        std::size_t slot = lookup(key);
+        if (slot == NOT_FOUND) {
+            return false;
+        }
+
+        _slots[slot].~Slot();
+        --_size;
+
+        // A group that still has an empty slot was never full, so no probe sequence continued past it.
+        HashMapGroup group(_ctrl + (slot & ~(HashMapGroup::WIDTH - 1)));
+        if (group.matchEmpty().any() == true) {
+            _ctrl[slot] = HashMapControl::EMPTY;
+        } else {
+            _ctrl[slot] = HashMapControl::DELETED;
+            ++_deleted;
+        }
+
+        return true;
+    }
+
+    void clear() {
+        std::size_t slotCount = slotCountOf();
+        for (std::size_t i = 0; i < slotCount; ++i) {
+            if (_ctrl[i] >= 0) {
+                _slots[i].~Slot();
+            }
+        }
+
+        std::memset(_ctrl, HashMapControl::EMPTY, slotCount);
+        _size = 0;
+        _deleted = 0;
+    }
+
+    /**
+     * @brief Calls function(key, value) for every item in the map, in no particular order.
+     */
+    template <typename Tfunction>
+    void forEach(Tfunction function) {
+        std::size_t slotCount = slotCountOf();
+        for (std::size_t i = 0; i < slotCount; ++i) {
+            if (_ctrl[i] >= 0) {
+                function(static_cast<const K &>(_slots[i].key), _slots[i].value);
+            }
+        }
+    }
+
+private:
+    struct Slot {
+        Slot(const K &k, const V &v) : key(k), value(v) {
+        }
+
+        K key;
+        V value;
+    };
+
+    static constexpr std::size_t NOT_FOUND = static_cast<std::size_t>(-1);
+
+    std::size_t slotCountOf() const {
+        return (_slots != nullptr) ? ((_groupMask + 1) * HashMapGroup::WIDTH) : 0;
+    }
+
+    std::size_t maxLoad() const {
+        return (slotCountOf() / 8) * 7;
+    }
+
+    // The low 7 bits of the mixed hash go into the control byte, the remaining bits select the first group.
+    std::size_t hashOf(const K &key) const {
+        const std::size_t multiplier = static_cast<std::size_t>(0x9E3779B97F4A7C15ull);
+        std::size_t hash = static_cast<std::size_t>(_hash(key)) * multiplier;
+        return hash ^ (hash >> (std::numeric_limits<std::size_t>::digits / 2));
+    }
+
+    static std::int8_t h2(std::size_t hash) {
+        return static_cast<std::int8_t>(hash & 0x7Fu);
+    }
+
+    // Groups are probed quadratically, which visits every group once because the group count is a power of 2.
+    std::size_t firstGroup(std::size_t hash) const {
+        return (hash >> 7) & _groupMask;
+    }
+
+    std::size_t lookup(const K &key) const {
+        return lookup(key, hashOf(key));
+    }
+
+    std::size_t lookup(const K &key, std::size_t hash) const {
+        if (_slots == nullptr) {
+            return NOT_FOUND;
+        }
+
+        std::size_t group = firstGroup(hash);
+        for (std::size_t step = 1; step <= (_groupMask + 1); ++step) {
+            std::size_t base = group * HashMapGroup::WIDTH;
+            HashMapGroup controls(_ctrl + base);
+
+            for (HashMapMatch match = controls.match(h2(hash)); match.any(); match.next()) {
+                std::size_t slot = base + match.lowest();
+                if (_slots[slot].key == key) {
+                    return slot;
+                }
+            }
+
+            if (controls.matchEmpty().any() == true) {
+                return NOT_FOUND;
+            }
+
+            group = (group + step) & _groupMask;
+        }
+
+        return NOT_FOUND;
+    }
+
+    // Finds the first empty or deleted slot on the probe sequence of hash, there always is one below capacity.
+    std::size_t findFree(std::size_t hash) const {
+        std::size_t group = firstGroup(hash);
+        for (std::size_t step = 1;; ++step) {
+            std::size_t base = group * HashMapGroup::WIDTH;
+            HashMapMatch match = HashMapGroup(_ctrl + base).matchEmptyOrDeleted();
+            if (match.any() == true) {
+                return base + match.lowest();
+            }
+            group = (group + step) & _groupMask;
+        }
+    }
+
+    // Rebuilds the table in place without tombstones, like a rehash into a table of the same size.
+    void purgeDeleted() {
+        std::size_t slotCount = slotCountOf();
+
+        // Every item is marked DELETED while it waits to be put back, all other slots become EMPTY.
+        for (std::size_t i = 0; i < slotCount; ++i) {
+            _ctrl[i] = (_ctrl[i] >= 0) ? HashMapControl::DELETED : HashMapControl::EMPTY;
+        }
+
+        for (std::size_t i = 0; i < slotCount; ++i) {
+            if (_ctrl[i] != HashMapControl::DELETED) {
+                continue;
+            }
+
+            std::size_t hash = hashOf(_slots[i].key);
+            std::size_t target = findFree(hash);
+
+            if ((target / HashMapGroup::WIDTH) == (i / HashMapGroup::WIDTH)) {
+
+                // The item is already in the first group with room on its probe sequence.
+                _ctrl[i] = h2(hash);
+
+            } else if (_ctrl[target] == HashMapControl::EMPTY) {
+
+                new (&_slots[target]) Slot(std::move(_slots[i]));
+                _slots[i].~Slot();
+                _ctrl[target] = h2(hash);
+                _ctrl[i] = HashMapControl::EMPTY;
+
+            } else {
+
+                // The target holds another item that still has to be put back, swap and process slot i again.
+                std::swap(_slots[i].key, _slots[target].key);
+                std::swap(_slots[i].value, _slots[target].value);
+                _ctrl[target] = h2(hash);
+                --i;
+            }
+        }
+
+        _deleted = 0;
+    }
+
+    Allocator &_allocator;
+    Thash _hash;
+    Slot *_slots;
+    std::int8_t *_ctrl;
+    std::size_t _capacity;
+    std::size_t _groupMask;
+    std::size_t _size;
+    std::size_t _deleted;
+};
+
+} // ecpp
+
+#endif // HASHMAP_H
@@ -0,0 +1,400 @@
+/*
+ * Copyright 2015 Erik Van Hamme
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef INTRUSIVELIST_H
+#define INTRUSIVELIST_H
+
+#include <cstddef>
+
+namespace ecpp {
+
+// This prototype is required to make sure IntrusiveListHook can be used in the prototypes below.
+template <typename T>
+class IntrusiveListHook;
+
+// This prototype is required to make sure IntrusiveList can be used in the definition of IntrusiveListHook.
+template <typename T, IntrusiveListHook<T> T::*Hook>
+class IntrusiveList;
+
+// This prototype is required to make sure IntrusiveListIterator can be used in the definition of IntrusiveListHook.
+template <typename T, IntrusiveListHook<T> T::*Hook>
+class IntrusiveListIterator;
+
+// This prototype is required to make sure ConstIntrusiveListIterator can be used in the definition of IntrusiveListHook.
+template <typename T, IntrusiveListHook<T> T::*Hook>
+class ConstIntrusiveListIterator;
+
+/**
+ * @brief Hook to embed in a type that needs to be stored in an IntrusiveList.
+ *
+ * The hook holds the links of the list, so inserting and removing items never allocates. A type can be a member of
+ * several lists at once by embedding one hook per list. An item can only be in one list per hook at any time.
+ *
+ * Example:
+ *
+ *     struct Job {
+ *         IntrusiveListHook<Job> readyHook;
+ *         IntrusiveListHook<Job> allHook;
+ *     };
+ *
+ *     IntrusiveList<Job, &Job::readyHook> readyQueue;
+ *     IntrusiveList<Job, &Job::allHook> allJobs;
+ */
+template <typename T>
+class IntrusiveListHook {
+public:
+    IntrusiveListHook() : _next(nullptr), _previous(nullptr) {
+    }
+
+    // Copying an item must not copy its membership of a list.
+    IntrusiveListHook(const IntrusiveListHook &other) : _next(nullptr), _previous(nullptr) {
+        (void) other;
+    }
+
+    IntrusiveListHook &operator =(const IntrusiveListHook &other) {
+        (void) other;
+        return *this;
+    }
+
+private:
+    T *_next;
+    T *_previous;
+
+    template <typename U, IntrusiveListHook<U> U::*>
+    friend class IntrusiveList;
+
+    template <typename U, IntrusiveListHook<U> U::*>
+    friend class IntrusiveListIterator;
+
+    template <typename U, IntrusiveListHook<U> U::*>
+    friend class ConstIntrusiveListIterator;
+};
+
+template <typename T, IntrusiveListHook<T> T::*Hook>
+class IntrusiveListIterator {
+public:
+    IntrusiveListIterator(IntrusiveList<T, Hook> &list, T *item) : _list(list), _item(item) {
+    }
+
+    bool insertAfter(T &item) {
+
+        // This protects against calling insertAfter on null iterator of the intrusive list.
+        if ((_item == nullptr) && (_list._head != nullptr)) {
+            return false;
+        }
+
+        IntrusiveListHook<T> &newHook = item.*Hook;
+
+        if (_item != nullptr) {
+
+            /*
+             * This branch deals with updating a non-empty list.
+             */
+
+            IntrusiveListHook<T> &hook = _item->*Hook;
+
+            newHook._previous = _item;
+            newHook._next = hook._next;
+
+            if (hook._next != nullptr) {
+                (hook._next->*Hook)._previous = &item;
+            } else {
+                // If there was no next item, we have added at the end of the list and we must update the tail.
+                _list._tail = &item;
+            }
+
+            hook._next = &item;
+
+        } else {
+
+            /*
+             * This branch deals with starting an empty list.
+             */
+
+            newHook._next = nullptr;
+            newHook._previous = nullptr;
+
+            _list._head = &item;
+            _list._tail = &item;
+        }
+
+        // Point to the newly inserted item.
+        _item = &item;
+
+        _list._size++;
+
+        return true;
+    }
+
+    bool insertBefore(T &item) {
+
+        // This protects against calling insertBefore on null iterator of the intrusive list.
+        if ((_item == nullptr) && (_list._head != nullptr)) {
+            return false;
+        }
+
+        IntrusiveListHook<T> &newHook = item.*Hook;
+
+        if (_item != nullptr) {
+
+            /*
+             * This branch deals with updating a non-empty list.
+             */
+
+            IntrusiveListHook<T> &hook = _item->*Hook;
+
+            newHook._next = _item;
+            newHook._previous = hook._previous;
+
+            if (hook._previous != nullptr) {
+                (hook._previous->*Hook)._next = &item;
+            } else {
+                // If there was no previous item, we have inserted at the start of the list and must update the head.
+                _list._head = &item;
+            }
+
+            hook._previous = &item;
+
+        } else {
+
+            /*
+             * This branch deals with starting an empty list.
+             */
+
+            newHook._next = nullptr;
+            newHook._previous = nullptr;
+
+            _list._head = &item;
+            _list._tail = &item;
+        }
+
+        // Point to the newly inserted item.
+        _item = &item;
+
+        _list._size++;
+
+        return true;
+    }
+
+    bool remove() {
+
+        if (_item == nullptr) {
+            return false;
+        }
+
+        T *target = (_item->*Hook)._next;
+        _list.unlink(*_item);
+        _item = target;
+
+        return true;
+    }
+
+    IntrusiveListIterator<T, Hook> &operator ++() {
+        if (_item != nullptr) {
+            _item = (_item->*Hook)._next;
+        }
+        return *this;
+    }
+
+    IntrusiveListIterator<T, Hook> &operator --() {
+        if (_item != nullptr) {
+            _item = (_item->*Hook)._previous;
+        }
+        return *this;
+    }
+
+    bool operator !=(const IntrusiveListIterator<T, Hook> &other) const {
+        if (other._item != nullptr) {
+            return _item != (other._item->*Hook)._next;
+        } else {
+            return _item != other._item;
+        }
+    }
+
+    T &operator *() {
+        return *_item;
+    }
+
+    T *operator ->() {
+        return _item;
+    }
+
+private:
+    IntrusiveList<T, Hook> &_list;
+    T *_item;
+};
+
+template <typename T, IntrusiveListHook<T> T::*Hook>
+class ConstIntrusiveListIterator {
+public:
+    ConstIntrusiveListIterator(const T *item) : _item(item) {
+    }
+
+    ConstIntrusiveListIterator<T, Hook> &operator ++() {
+        if (_item != nullptr) {
+            _item = (_item->*Hook)._next;
+        }
+        return *this;
+    }
+
+    ConstIntrusiveListIterator<T, Hook> &operator --() {
+        if (_item != nullptr) {
+            _item = (_item->*Hook)._previous;
+        }
+        return *this;
+    }
+
+    bool operator !=(const ConstIntrusiveListIterator<T, Hook> &other) const {
+        if (other._item != nullptr) {
+            return _item != (other._item->*Hook)._next;
+        } else {
+            return _item != other._item;
+        }
+    }
+
+    const T &operator *() const {
+        return *_item;
+    }
+
+    const T *operator ->() const {
+        return _item;
+    }
+
+private:
+    const T *_item;
+};
+
+/**
+ * @brief Doubly linked list of items that embed their own links.
+ *
+ * Unlike LinkedList, this list does not own or copy its items and it never allocates. The caller is responsible for
+ * keeping an item alive while it is in the list and for removing it before it is destroyed.
+ */
+template <typename T, IntrusiveListHook<T> T::*Hook>
+class IntrusiveList {
+public:
+    IntrusiveList() : _head(nullptr), _tail(nullptr), _size(0) {
+    }
+
+    // Copying a list would make two lists share the same hooks.
+    IntrusiveList(const IntrusiveList &) = delete;
+    IntrusiveList &operator =(const IntrusiveList &) = delete;
+
+    std::size_t size() const {
+        return _size;
+    }
+
+    bool empty() const {
+        return _size == 0;
+    }
+
+    bool append(T &item) {
+        return end().insertAfter(item);
+    }
+
+    bool prepend(T &item) {
+        return begin().insertBefore(item);
+    }
+
+    T *front() const {
+        return _head;
+    }
+
+    T *back() const {
+        return _tail;
+    }
+
+    T *popFront() {
+        T *item = _head;
+        if (item != nullptr) {
+            unlink(*item);
+        }
+        return item;
+    }
+
+    T *popBack() {
+        T *item = _tail;
+        if (item != nullptr) {
+            unlink(*item);
+        }
+        return item;
+    }
+
+    /**
+     * @brief Removes an item from the list in constant time.
+     *
+     * @param [in] item An item which must be in this list.
+     */
+    void remove(T &item) {
+        unlink(item);
+    }
+
+    void clear() {
+        while (_head != nullptr) {
+            unlink(*_head);
+        }
+    }
+
+    IntrusiveListIterator<T, Hook> begin() {
+        return IntrusiveListIterator<T, Hook>(*this, _head);
+    }
+
+    ConstIntrusiveListIterator<T, Hook> begin() const {
+        return ConstIntrusiveListIterator<T, Hook>(_head);
+    }
+
+    IntrusiveListIterator<T, Hook> end() {
+        return IntrusiveListIterator<T, Hook>(*this, _tail);
+    }
+
+    ConstIntrusiveListIterator<T, Hook> end() const {
+        return ConstIntrusiveListIterator<T, Hook>(_tail);
+    }
+
+private:
+
+    void unlink(T &item) {
+        IntrusiveListHook<T> &hook = item.*Hook;
+
+        if (hook._previous != nullptr) {
+            (hook._previous->*Hook)._next = hook._next;
+        } else {
+            _head = hook._next;
+        }
+
+        if (hook._next != nullptr) {
+            (hook._next->*Hook)._previous = hook._previous;
+        } else {
+            _tail = hook._previous;
+        }
+
+        hook._next = nullptr;
+        hook._previous = nullptr;
+
+        --_size;
+    }
+
+    T *_head;
+    T *_tail;
+    std::size_t _size;
+
+    // IntrusiveListIterator<T, Hook> needs access to _size, _head, _tail and unlink.
+    friend class IntrusiveListIterator<T, Hook>;
+};
+
+} // ecpp
+
+#endif // INTRUSIVELIST_H
@@ -21,6 +21,7 @@
 #include "comparator.h"
 
 #include <cstddef>
+#include <new>
 
 // TODO: Check if the iterators and entry class can be nested into the LinkedList class.
 
@@ -187,11 +188,17 @@ public:
             // Only next is present, link _next->_previous to nullptr. We must also adjust the head of the list.
             _entry->_next->_previous = nullptr;
             _list._head = _entry->_next;
+
+        } else {
+
+            // This was the only entry, the list is empty now.
+            _list._head = nullptr;
+            _list._tail = nullptr;
         }
 
-        // De-allocate the entry and point to the next entry if there is one.
+        // Release the entry and point to the next entry if there is one.
         LinkedListEntry<T> *target = (hasNext == true) ? _entry->_next : nullptr;
-        _list._allocator.deallocate(_entry);
+        _list.releaseEntry(_entry);
         _entry = target;
         --_list._size;
 
@@ -231,8 +238,8 @@ public:
 private:
     LinkedListEntry<T> *makeEntry(T item) {
 
-        // Allocate memory for the new entry instance.
-        void * mem = _list._allocator.allocate(LinkedListEntry<T>::LINKED_LIST_ENTRY_SIZE);
+        // Take memory for the new entry instance, from the reserved entries if there are any.
+        void * mem = _list.acquireEntry();
 
         // If no memory available return the nullptr.
         if (mem == nullptr) {
@@ -247,6 +254,9 @@ private:
 
     LinkedList<T> &_list;
     LinkedListEntry<T> *_entry;
+
+    // LinkedList<T> needs access to _list and _entry to splice entries.
+    friend class LinkedList<T>;
 };
 
 template <typename T>
@@ -292,13 +302,66 @@ private:
 template <typename T>
 class LinkedList {
 public:
-    LinkedList(Allocator &allocator) : _allocator(allocator), _head(nullptr), _tail(nullptr), _size(0) {
+    LinkedList(Allocator &allocator) : _allocator(allocator), _head(nullptr), _tail(nullptr), _size(0),
+            _pool(nullptr), _poolSize(0), _poolCapacity(0) {
+    }
+
+    ~LinkedList() {
+        clear();
+        reserve(0);
     }
 
+    // Copying a list would make two lists share the same entries.
+    LinkedList(const LinkedList &) = delete;
+    LinkedList &operator =(const LinkedList &) = delete;
+
     std::size_t size() const {
         return _size;
     }
 
+    /**
+     * @brief Returns the number of items the list can hold without calling the allocator.
+     */
+    std::size_t capacity() const {
+        return _size + _poolSize;
+    }
+
+    /**
+     * @brief Reserves entries up front so the next inserts do not need to call the allocator.
+     *
+     * The reserved entries are kept in a pool of the list. Entries released by remove() go back to this pool until it
+     * holds n entries again, any entries beyond that go back to the allocator. Calling reserve(0) gives all pooled
+     * entries back to the allocator.
+     *
+     * @param [in] n The number of entries to keep ready for inserting.
+     *
+     * @return True if n entries are ready, false if the allocator ran out of memory. The entries that could be
+     *         allocated stay in the pool.
+     */
+    bool reserve(std::size_t n) {
+
+        _poolCapacity = n;
+
+        while (_poolSize > _poolCapacity) {
+            void *mem = _pool;
+            _pool = *reinterpret_cast<void **>(mem);
+            --_poolSize;
+            _allocator.deallocate(mem);
+        }
+
+        while (_poolSize < _poolCapacity) {
+            void *mem = _allocator.allocate(LinkedListEntry<T>::LINKED_LIST_ENTRY_SIZE);
+            if (mem == nullptr) {
+                return false;
+            }
+            *reinterpret_cast<void **>(mem) = _pool;
+            _pool = mem;
+            ++_poolSize;
+        }
+
+        return true;
+    }
+
     bool append(T item) {
         return end().insertAfter(item);
     }
@@ -307,6 +370,58 @@ public:
         return begin().insertBefore(item);
     }
 
+    /**
+     * @brief Appends all items in the range [first, last) to the end of the list.
+     *
+     * All entries are allocated before any of them is linked in, so the list is left untouched when the allocator runs
+     * out of memory half way through.
+     *
+     * @param [in] first Iterator to the first item to append.
+     * @param [in] last Iterator past the last item to append.
+     *
+     * @return True if all items were appended, false if the list was left unchanged.
+     */
+    template <typename Titerator>
+    bool append(Titerator first, Titerator last) {
+
+        LinkedListEntry<T> *chainHead = nullptr;
+        LinkedListEntry<T> *chainTail = nullptr;
+        std::size_t count = 0;
+
+        for (; first != last; ++first) {
+
+            void *mem = acquireEntry();
+
+            if (mem == nullptr) {
+
+                // Give back what was already allocated for this call.
+                while (chainHead != nullptr) {
+                    LinkedListEntry<T> *next = chainHead->_next;
+                    releaseEntry(chainHead);
+                    chainHead = next;
+                }
+                return false;
+            }
+
+            LinkedListEntry<T> *newEntry = new (mem) LinkedListEntry<T>(*first);
+
+            if (chainTail != nullptr) {
+                chainTail->_next = newEntry;
+                newEntry->_previous = chainTail;
+            } else {
+                chainHead = newEntry;
+            }
+            chainTail = newEntry;
+            ++count;
+        }
+
+        if (count != 0) {
+            linkAtEnd(chainHead, chainTail, count);
+        }
+
+        return true;
+    }
+
     const T at(const std::size_t pos) const {
         LinkedListEntry<T> *entry = findEntry(pos);
         if (entry == nullptr) {
@@ -382,6 +497,162 @@ public:
         return true;
     }
 
+    /**
+     * @brief Moves all entries of another list to the end of this list.
+     *
+     * When both lists use the same allocator, the entries are relinked in constant time without any allocator calls.
+     * Otherwise every item is copied into a new entry of this list and removed from the other list.
+     *
+     * @param [in,out] other The list to take the entries from, it will be empty afterwards on success.
+     *
+     * @return True on success, false if other is this list or an allocation failed.
+     */
+    bool splice(LinkedList<T> &other) {
+
+        if (&other == this) {
+            return false;
+        }
+
+        if (other._size == 0) {
+            return true;
+        }
+
+        if (&other._allocator == &_allocator) {
+            LinkedListEntry<T> *first = other._head;
+            LinkedListEntry<T> *last = other._tail;
+            std::size_t count = other._size;
+
+            other.unlink(first, last, count);
+            linkAtEnd(first, last, count);
+
+            return true;
+        }
+
+        while (other._size != 0) {
+            LinkedListIterator<T> item = other.begin();
+            if (splice(item) == false) {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    /**
+     * @brief Moves a single entry of another list to the end of this list.
+     *
+     * @param [in,out] item Iterator to the entry to move. Like LinkedListIterator::remove, it will point to the next
+     *                      entry of the other list afterwards.
+     *
+     * @return True on success, false if the iterator is null, belongs to this list or an allocation failed.
+     */
+    bool splice(LinkedListIterator<T> &item) {
+        return splice(item, item);
+    }
+
+    /**
+     * @brief Moves the entries from first up to and including last of another list to the end of this list.
+     *
+     * When both lists use the same allocator, the entries are relinked without any allocator calls. The range is only
+     * walked to count the entries.
+     *
+     * @param [in,out] first Iterator to the first entry to move, it will point to the entry after last afterwards.
+     * @param [in] last Iterator to the last entry to move, this must be first or an entry after first.
+     *
+     * @return True on success, false if the range is not valid or an allocation failed.
+     */
+    bool splice(LinkedListIterator<T> &first, const LinkedListIterator<T> &last) {
+
+        LinkedList<T> &other = first._list;
+
+        if ((&other == this) || (&last._list != &other)) {
+            return false;
+        }
+
+        if ((first._entry == nullptr) || (last._entry == nullptr)) {
+            return false;
+        }
+
+        // Count the entries in the range, this also checks that last can be reached from first.
+        std::size_t count = 1;
+        for (LinkedListEntry<T> *entry = first._entry; entry != last._entry; entry = entry->_next) {
+            if (entry->_next == nullptr) {
+                return false;
+            }
+            ++count;
+        }
+
+        if (&other._allocator == &_allocator) {
+            LinkedListEntry<T> *target = last._entry->_next;
+
+            other.unlink(first._entry, last._entry, count);
+            linkAtEnd(first._entry, last._entry, count);
+
+            first._entry = target;
+
+            return true;
+        }
+
+        for (std::size_t i = 0; i < count; ++i) {
+            if (append(first._entry->_item) == false) {
+                return false;
+            }
+            first.remove();
+        }
+
+        return true;
+    }
+
+    /**
+     * @brief Merges another sorted list into this sorted list.
+     *
+     * Both lists must be sorted according to comp. The merge is stable: of two equal items, the one from this list
+     * comes first. When both lists use the same allocator, the entries are relinked without any allocator calls.
+     *
+     * @param [in,out] other The list to merge in, it will be empty afterwards on success.
+     * @param [in] comp The comparator both lists are sorted by.
+     *
+     * @return True on success, false if other is this list or an allocation failed.
+     */
+    bool merge(LinkedList<T> &other, const Comparator<T> &comp) {
+
+        if (&other == this) {
+            return false;
+        }
+
+        bool sameAllocator = (&other._allocator == &_allocator);
+        LinkedListEntry<T> *position = _head;
+
+        while (other._head != nullptr) {
+
+            LinkedListEntry<T> *entry = other._head;
+
+            // Skip over the items in this list that do not come after the item from the other list.
+            while ((position != nullptr) && (comp.compare(entry->_item, position->_item) <= 0)) {
+                position = position->_next;
+            }
+
+            if (position == nullptr) {
+
+                // Everything left in the other list goes to the end of this list.
+                return splice(other);
+            }
+
+            if (sameAllocator == true) {
+                other.unlink(entry, entry, 1);
+                linkBefore(position, entry, entry, 1);
+            } else {
+                LinkedListIterator<T> inserter(*this, position);
+                if (inserter.insertBefore(entry->_item) == false) {
+                    return false;
+                }
+                other.begin().remove();
+            }
+        }
+
+        return true;
+    }
+
     void sort(const Comparator<T> &comp) {
         (void) comp;
         // TODO: implement me.
@@ -416,12 +687,95 @@ private:
         return entry;
     }
 
+    // Takes the memory for one entry, from the pool if possible, otherwise from the allocator.
+    void *acquireEntry() {
+        if (_pool != nullptr) {
+            void *mem = _pool;
+            _pool = *reinterpret_cast<void **>(mem);
+            --_poolSize;
+            return mem;
+        }
+        return _allocator.allocate(LinkedListEntry<T>::LINKED_LIST_ENTRY_SIZE);
+    }
+
+    // Destroys an entry and returns its memory to the pool, or to the allocator if the pool is full.
+    void releaseEntry(LinkedListEntry<T> *entry) {
+        entry->~LinkedListEntry<T>();
+
+        void *mem = entry;
+        if (_poolSize < _poolCapacity) {
+            *reinterpret_cast<void **>(mem) = _pool;
+            _pool = mem;
+            ++_poolSize;
+        } else {
+            _allocator.deallocate(mem);
+        }
+    }
+
+    // Detaches the count entries from first up to and including last without de-allocating them.
+    void unlink(LinkedListEntry<T> *first, LinkedListEntry<T> *last, std::size_t count) {
+
+        if (first->_previous != nullptr) {
+            first->_previous->_next = last->_next;
+        } else {
+            _head = last->_next;
+        }
+
+        if (last->_next != nullptr) {
+            last->_next->_previous = first->_previous;
+        } else {
+            _tail = first->_previous;
+        }
+
+        first->_previous = nullptr;
+        last->_next = nullptr;
+
+        _size -= count;
+    }
+
+    // Links a detached chain of count entries from first up to and including last at the end of the list.
+    void linkAtEnd(LinkedListEntry<T> *first, LinkedListEntry<T> *last, std::size_t count) {
+
+        first->_previous = _tail;
+
+        if (_tail != nullptr) {
+            _tail->_next = first;
+        } else {
+            _head = first;
+        }
+
+        _tail = last;
+        _size += count;
+    }
+
+    // Links a detached chain of count entries from first up to and including last in front of position.
+    void linkBefore(LinkedListEntry<T> *position, LinkedListEntry<T> *first, LinkedListEntry<T> *last,
+                    std::size_t count) {
+
+        first->_previous = position->_previous;
+        last->_next = position;
+
+        if (position->_previous != nullptr) {
+            position->_previous->_next = first;
+        } else {
+            _head = first;
+        }
+
+        position->_previous = last;
+        _size += count;
+    }
+
     Allocator &_allocator;
     LinkedListEntry<T> *_head;
     LinkedListEntry<T> *_tail;
     std::size_t _size;
 
-    // LinkedListIterator<T> needs access to _size, _head, _tail and _allocator.
+    // Free entry memory, chained through the first pointer sized word of each entry.
+    void *_pool;
+    std::size_t _poolSize;
+    std::size_t _poolCapacity;
+
+    // LinkedListIterator<T> needs access to _size, _head, _tail, acquireEntry and releaseEntry.
     friend class LinkedListIterator<T>;
 };
 
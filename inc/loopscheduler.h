@@ -0,0 +1,205 @@
+/*
+ * Copyright 2015 Erik Van Hamme
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef LOOPSCHEDULER_H
+#define LOOPSCHEDULER_H
+
+#include "allocator.h"
+#include "pid.h"
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+namespace ecpp {
+
+/**
+ * @brief Timing statistics of one periodic task.
+ *
+ * Jitter is the time from the release of a run to its start, response is the time from the release to the end.
+ */
+struct LoopStatistics {
+    std::uint64_t runs;
+    std::uint64_t overruns;
+    std::uint64_t skippedReleases;
+    std::chrono::nanoseconds maxJitter;
+    std::chrono::nanoseconds meanJitter;
+    std::chrono::nanoseconds maxExecution;
+    std::chrono::nanoseconds maxResponse;
+};
+
+/**
+ * @brief Runs periodic tasks, such as PID loops, on a fixed set of worker threads.
+ *
+ * Tasks are added before start() and every task is assigned to one worker for good (partitioned scheduling). Unless
+ * a worker is chosen explicitly, a task goes to the worker with the lowest utilisation, estimated from the cost and
+ * period of its tasks. Each worker keeps the next release time of its tasks in a PriorityQueue, sleeps until the
+ * earliest one and runs the task. Workers are pinned to one CPU each where the platform supports it.
+ *
+ * A run that ends after its deadline counts as an overrun. When a run ends after one or more later releases of the
+ * same task, those releases are skipped instead of run back to back, so a slow run does not start a burst.
+ *
+ * Tasks are plain function pointers with a context pointer, the scheduler does not allocate after start().
+ */
+class LoopScheduler {
+public:
+    typedef std::chrono::steady_clock Clock;
+    typedef void (*Function)(void *context);
+    typedef std::size_t TaskId;
+
+    static constexpr TaskId INVALID_TASK = static_cast<TaskId>(-1);
+    static constexpr std::size_t ANY_WORKER = static_cast<std::size_t>(-1);
+
+    struct TaskConfig {
+        // Time between releases.
+        Clock::duration period;
+
+        // Time after the release by which the run must have ended, 0 for the period.
+        Clock::duration deadline;
+
+        // Expected execution time, only used to balance the workers.
+        Clock::duration cost;
+
+        // Worker to run the task on, or ANY_WORKER.
+        std::size_t worker;
+    };
+
+    /**
+     * @brief Creates a stopped scheduler.
+     *
+     * @param [in] allocator Provides the memory for the tasks and the workers.
+     * @param [in] capacity The maximum number of tasks.
+     * @param [in] workerCount The number of worker threads, 0 for one per hardware thread.
+     * @param [in] pin True to pin worker n to CPU n.
+     */
+    LoopScheduler(Allocator &allocator, std::size_t capacity, std::size_t workerCount = 0, bool pin = true);
+
+    /**
+     * @brief Stops the workers and releases the memory.
+     */
+    ~LoopScheduler();
+
+    LoopScheduler(const LoopScheduler &) = delete;
+    LoopScheduler &operator =(const LoopScheduler &) = delete;
+
+    std::size_t capacity() const {
+        return _capacity;
+    }
+
+    std::size_t size() const {
+        return _size;
+    }
+
+    std::size_t workerCount() const {
+        return _workerCount;
+    }
+
+    bool isRunning() const {
+        return _running;
+    }
+
+    /**
+     * @brief Adds a task that calls function(context) every period.
+     *
+     * @return The id of the task, or INVALID_TASK if the scheduler is running or full, the period is 0 or the worker
+     *         does not exist.
+     */
+    TaskId add(Function function, void *context, const TaskConfig &config);
+
+    /**
+     * @brief Adds a task that calls callable() every period, callable must outlive the scheduler run.
+     */
+    template <typename T>
+    TaskId add(T &callable, const TaskConfig &config) {
+        return add(&invoke<T>, &callable, config);
+    }
+
+    /**
+     * @brief Returns the worker that runs the task.
+     */
+    std::size_t workerOf(TaskId task) const;
+
+    /**
+     * @brief Starts the workers, the first release of every task is now.
+     *
+     * @return True on success, false if the scheduler was already running or the memory for the release queues could
+     *         not be allocated.
+     */
+    bool start();
+
+    /**
+     * @brief Stops the workers after their current runs and waits for them. Tasks and statistics are kept.
+     */
+    void stop();
+
+    /**
+     * @brief Returns the statistics of a task, they can be read while the scheduler runs.
+     */
+    LoopStatistics statistics(TaskId task) const;
+
+    void resetStatistics(TaskId task);
+
+private:
+    struct Task;
+    struct Worker;
+
+    template <typename T>
+    static void invoke(void *callable) {
+        (*static_cast<T *>(callable))();
+    }
+
+    void run(Worker &worker);
+
+    Allocator &_allocator;
+    Task *_tasks;
+    Worker *_workers;
+    std::size_t _capacity;
+    std::size_t _size;
+    std::size_t _workerCount;
+    bool _pin;
+    bool _running;
+};
+
+/**
+ * @brief Task that runs one Pid step: read the signal, update the loop and write the output.
+ *
+ * Add it to a LoopScheduler as a callable, the read and write functions get the given context.
+ */
+template <typename Tsignal = float, typename Tout = float, typename Tcfg = float>
+class PidLoop {
+public:
+    typedef Tsignal (*Read)(void *context);
+    typedef void (*Write)(const Tout &output, void *context);
+
+    PidLoop(Pid<Tsignal, Tout, Tcfg> &pid, Read read, Write write, void *context) : _pid(pid), _read(read),
+            _write(write), _context(context) {
+    }
+
+    void operator ()() {
+        _pid.update(_read(_context));
+        _write(_pid.output(), _context);
+    }
+
+private:
+    Pid<Tsignal, Tout, Tcfg> &_pid;
+    Read _read;
+    Write _write;
+    void *_context;
+};
+
+} // ecpp
+
+#endif // LOOPSCHEDULER_H
@@ -0,0 +1,310 @@
+/*
+ * Copyright 2015 Erik Van Hamme
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef LRUCACHE_H
+#define LRUCACHE_H
+
+#include "allocator.h"
+#include "intrusivelist.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <new>
+
+namespace ecpp {
+
+/**
+ * @brief Fixed capacity cache that evicts the least recently used entry when it is full.
+ *
+ * All entries are allocated in one block when the cache is constructed and linked into a recency list through an
+ * IntrusiveList, so lookups, touches and evictions never call the allocator. Keys are located through an open
+ * addressing index with linear probing.
+ *
+ * If the allocator cannot provide the memory, the cache ends up with a capacity of 0 and every insert fails.
+ */
+template <typename K, typename V, typename Thash = std::hash<K>>
+class LruCache {
+public:
+    LruCache(Allocator &allocator, std::size_t capacity, const Thash &hash = Thash()) : _allocator(allocator),
+            _hash(hash), _entries(nullptr), _index(nullptr), _capacity(0), _indexMask(0), _indexShift(0), _hits(0),
+            _misses(0), _evictions(0) {
+
+        if (capacity == 0) {
+            return;
+        }
+
+        // Keep the index at most half full so probe sequences stay short.
+        std::size_t indexSize = 2;
+        unsigned int indexBits = 1;
+        while (indexSize < (2 * capacity)) {
+            indexSize <<= 1;
+            ++indexBits;
+        }
+
+        void *entryMem = _allocator.allocate(sizeof(Entry) * capacity);
+        void *indexMem = _allocator.allocate(sizeof(Entry *) * indexSize);
+        if ((entryMem == nullptr) || (indexMem == nullptr)) {
+            if (entryMem != nullptr) {
+                _allocator.deallocate(entryMem);
+            }
+            if (indexMem != nullptr) {
+                _allocator.deallocate(indexMem);
+            }
+            return;
+        }
+
+        _entries = static_cast<Entry *>(entryMem);
+        _index = static_cast<Entry **>(indexMem);
+        _capacity = capacity;
+        _indexMask = indexSize - 1;
+        _indexShift = std::numeric_limits<std::size_t>::digits - indexBits;
+
+        for (std::size_t i = 0; i < _capacity; ++i) {
+            new (&_entries[i]) Entry();
+            _free.append(_entries[i]);
+        }
+
+        for (std::size_t i = 0; i < indexSize; ++i) {
+            _index[i] = nullptr;
+        }
+    }
+
+    ~LruCache() {
+        if (_capacity != 0) {
+            _recent.clear();
+            _free.clear();
+
+            for (std::size_t i = 0; i < _capacity; ++i) {
+                _entries[i].~Entry();
+            }
+
+            _allocator.deallocate(_entries);
+            _allocator.deallocate(_index);
+        }
+    }
+
+    LruCache(const LruCache &) = delete;
+    LruCache &operator =(const LruCache &) = delete;
+
+    std::size_t capacity() const {
+        return _capacity;
+    }
+
+    std::size_t size() const {
+        return _recent.size();
+    }
+
+    /**
+     * @brief Looks up a key and marks it as most recently used.
+     *
+     * @return Pointer to the cached value, or nullptr if the key is not cached. The pointer stays valid until the entry
+     *         is erased or evicted.
+     */
+    V *find(const K &key) {
+        Entry *entry = lookup(key);
+        if (entry == nullptr) {
+            ++_misses;
+            return nullptr;
+        }
+
+        ++_hits;
+        moveToFront(*entry);
+
+        return &entry->value;
+    }
+
+    /**
+     * @brief Checks if a key is cached without marking it as used and without updating the counters.
+     */
+    bool contains(const K &key) const {
+        return lookup(key) != nullptr;
+    }
+
+    /**
+     * @brief Marks a key as most recently used without updating the counters.
+     *
+     * @return True if the key is cached.
+     */
+    bool touch(const K &key) {
+        Entry *entry = lookup(key);
+        if (entry == nullptr) {
+            return false;
+        }
+
+        moveToFront(*entry);
+
+        return true;
+    }
+
+    /**
+     * @brief Inserts or updates a key, evicting the least recently used entry if the cache is full.
+     *
+     * @return True on success, false if the cache has no capacity.
+     */
+    bool insert(const K &key, const V &value) {
+        Entry *entry = lookup(key);
+        if (entry != nullptr) {
+            entry->value = value;
+            moveToFront(*entry);
+            return true;
+        }
+
+        entry = _free.popFront();
+        if (entry == nullptr) {
+            entry = _recent.popBack();
+            if (entry == nullptr) {
+                return false;
+            }
+            unindex(*entry);
+            ++_evictions;
+        }
+
+        entry->key = key;
+        entry->value = value;
+        _recent.prepend(*entry);
+
+        std::size_t slot = home(key);
+        while (_index[slot] != nullptr) {
+            slot = (slot + 1) & _indexMask;
+        }
+        _index[slot] = entry;
+
+        return true;
+    }
+
+    /**
+     * @brief Removes a key from the cache.
+     *
+     * @return True if the key was cached.
+     */
+    bool erase(const K &key) {
+        Entry *entry = lookup(key);
+        if (entry == nullptr) {
+            return false;
+        }
+
+        unindex(*entry);
+        _recent.remove(*entry);
+        _free.append(*entry);
+
+        return true;
+    }
+
+    void clear() {
+        while (Entry *entry = _recent.popFront()) {
+            unindex(*entry);
+            _free.append(*entry);
+        }
+    }
+
+    std::uint32_t hits() const {
+        return _hits;
+    }
+
+    std::uint32_t misses() const {
+        return _misses;
+    }
+
+    std::uint32_t evictions() const {
+        return _evictions;
+    }
+
+    void resetStatistics() {
+        _hits = 0;
+        _misses = 0;
+        _evictions = 0;
+    }
+
+private:
+    struct Entry {
+        IntrusiveListHook<Entry> hook;
+        K key;
+        V value;
+    };
+
+    // Fibonacci hashing spreads weak hashes, like the identity hash of integers, over the whole index.
+    std::size_t home(const K &key) const {
+        const std::size_t multiplier = static_cast<std::size_t>(0x9E3779B97F4A7C15ull);
+        return (static_cast<std::size_t>(_hash(key)) * multiplier) >> _indexShift;
+    }
+
+    Entry *lookup(const K &key) const {
+        if (_capacity == 0) {
+            return nullptr;
+        }
+
+        std::size_t slot = home(key);
+        while (_index[slot] != nullptr) {
+            if (_index[slot]->key == key) {
+                return _index[slot];
+            }
+            slot = (slot + 1) & _indexMask;
+        }
+
+        return nullptr;
+    }
+
+    // Removes an entry from the index, shifting back later entries of the probe sequence to close the gap.
+    void unindex(const Entry &entry) {
+        std::size_t slot = home(entry.key);
+        while (_index[slot] != &entry) {
+            slot = (slot + 1) & _indexMask;
+        }
+
+        std::size_t gap = slot;
+        std::size_t next = (gap + 1) & _indexMask;
+        while (_index[next] != nullptr) {
+
+            // An entry can fill the gap if its home slot is not cyclically in (gap, next].
+            std::size_t nextHome = home(_index[next]->key);
+            if (((next - nextHome) & _indexMask) >= ((next - gap) & _indexMask)) {
+                _index[gap] = _index[next];
+                gap = next;
+            }
+            next = (next + 1) & _indexMask;
+        }
+
+        _index[gap] = nullptr;
+    }
+
+    void moveToFront(Entry &entry) {
+        if (_recent.front() != &entry) {
+            _recent.remove(entry);
+            _recent.prepend(entry);
+        }
+    }
+
+    Allocator &_allocator;
+    Thash _hash;
+    Entry *_entries;
+    Entry **_index;
+    std::size_t _capacity;
+    std::size_t _indexMask;
+    unsigned int _indexShift;
+
+    IntrusiveList<Entry, &Entry::hook> _recent;
+    IntrusiveList<Entry, &Entry::hook> _free;
+
+    std::uint32_t _hits;
+    std::uint32_t _misses;
+    std::uint32_t _evictions;
+};
+
+} // ecpp
+
+#endif // LRUCACHE_H
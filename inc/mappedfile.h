@@ -0,0 +1,68 @@
+/*
+ * Copyright 2015 Erik Van Hamme
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef MAPPEDFILE_H
+#define MAPPEDFILE_H
+
+#include <cstddef>
+
+namespace ecpp {
+
+/**
+ * @brief Maps a whole file into memory, to be used with BinaryReader or BinaryWriter.
+ *
+ * Only available on POSIX hosts, elsewhere open always fails.
+ */
+class MappedFile {
+public:
+    MappedFile();
+    ~MappedFile();
+
+    MappedFile(const MappedFile &) = delete;
+    MappedFile &operator =(const MappedFile &) = delete;
+
+    /**
+     * @brief Maps the file at path, closing any file that was mapped before.
+     *
+     * @param [in] path The file to map.
+     * @param [in] writable True to map the file shared and writable, changes then end up in the file.
+     *
+     * @return True on success, false if the file could not be opened or mapped.
+     */
+    bool open(const char *path, bool writable = false);
+
+    void close();
+
+    bool isOpen() const {
+        return _data != nullptr;
+    }
+
+    void *data() const {
+        return _data;
+    }
+
+    std::size_t size() const {
+        return _size;
+    }
+
+private:
+    void *_data;
+    std::size_t _size;
+};
+
+} // ecpp
+
+#endif // MAPPEDFILE_H
@@ -17,8 +17,12 @@
 #ifndef PID
 #define PID
 
+#include "fraction.h"
 #include "range.h"
+#include "utils.h"
 
+#include <cstdint>
+#include <limits>
 #include <type_traits>
 
 namespace ecpp {
@@ -29,8 +33,8 @@ namespace ecpp {
 
         static_assert(std::is_arithmetic<Tsignal>::value, "Signal type should be arithmetic type.");
         static_assert(std::is_arithmetic<Tout>::value, "Output type should be arithmetic type.");
-        // TODO: Enable when fraction is arithmetic type.
-        //static_assert(std::is_arithmetic<Tcfg>::value, "Config type should be arithmetic type.");
+        static_assert(std::is_arithmetic<Tcfg>::value || is_fraction<Tcfg>::value,
+                "Config type should be arithmetic type or Fraction.");
         static_assert(std::is_signed<Tsignal>::value, "Signal type should be signed type.");
 
         struct Config {
@@ -62,19 +66,25 @@ namespace ecpp {
             _accumulatedError = 0;
         }
 
+        /**
+         * @brief Runs one step of the loop.
+         *
+         * With integral signal and output types, everything is done in integer arithmetic that saturates instead of
+         * overflowing, so Fraction gains give a loop without floating point and with fixed timing.
+         */
         void update(const Tsignal &signal) {
-            Tsignal error = _cfg.setPoint - signal;
+            Tsignal error = subtract(_cfg.setPoint, signal, Integral());
 
-            Tout pOut = _cfg.pRange.apply(error * _cfg.p);
+            Tout pOut = _cfg.pRange.apply(scale(error, _cfg.p, Integral()));
 
-            _accumulatedError = _cfg.iRange.apply(_accumulatedError + error);
-            Tout iOut = _accumulatedError * _cfg.i;
+            _accumulatedError = _cfg.iRange.apply(add(_accumulatedError, error, Integral()));
+            Tout iOut = scale(_accumulatedError, _cfg.i, Integral());
 
-            Tsignal diff = error - _previousError;
-            Tout dOut = _cfg.dRange.apply(diff * _cfg.d);
+            Tsignal diff = subtract(error, _previousError, Integral());
+            Tout dOut = _cfg.dRange.apply(scale(diff, _cfg.d, Integral()));
             _previousError = error;
 
-            _output = _cfg.outRange.apply(pOut + iOut + dOut);
+            _output = _cfg.outRange.apply(add(add(pOut, iOut, Integral()), dOut, Integral()));
         }
 
         const Tout &output() const {
@@ -82,6 +92,59 @@ namespace ecpp {
         }
 
     private:
+        typedef std::integral_constant<bool, std::is_integral<Tsignal>::value && std::is_integral<Tout>::value> Integral;
+
+        // Floating point or mixed types: plain arithmetic.
+        template <typename Ta, typename Tb>
+        static auto subtract(const Ta &a, const Tb &b, std::false_type) -> decltype(a - b) {
+            return a - b;
+        }
+
+        template <typename Ta, typename Tb>
+        static auto add(const Ta &a, const Tb &b, std::false_type) -> decltype(a + b) {
+            return a + b;
+        }
+
+        template <typename Ta, typename Tb>
+        static auto scale(const Ta &a, const Tb &b, std::false_type) -> decltype(a * b) {
+            return a * b;
+        }
+
+        // Integral signal and output: saturating arithmetic with intmax_t intermediates.
+        static Tsignal subtract(const Tsignal &a, const Tsignal &b, std::true_type) {
+            return utils::saturate<Tsignal>(utils::saturatingSubtract(a, b));
+        }
+
+        template <typename Tb>
+        static Tout add(const Tout &a, const Tb &b, std::true_type) {
+            return utils::saturate<Tout>(utils::saturatingAdd(a, b));
+        }
+
+        template <typename Tvalue, typename Tnum, typename Tden>
+        static Tout scale(const Tvalue &value, const Fraction<Tnum, Tden> &gain, std::true_type) {
+            return utils::saturate<Tout>(utils::saturatingMulDiv(value, gain.getNum(), gain.getDen()));
+        }
+
+        template <typename Tvalue, typename Tgain>
+        static typename std::enable_if<std::is_integral<Tgain>::value, Tout>::type scale(const Tvalue &value,
+                const Tgain &gain, std::true_type) {
+            return utils::saturate<Tout>(utils::saturatingMulDiv(value, gain, 1));
+        }
+
+        // A floating point gain on integral signals: the product is limited before it is converted to Tout.
+        template <typename Tvalue, typename Tgain>
+        static typename std::enable_if<std::is_floating_point<Tgain>::value, Tout>::type scale(const Tvalue &value,
+                const Tgain &gain, std::true_type) {
+            Tgain product = value * gain;
+            if (product >= static_cast<Tgain>(std::numeric_limits<Tout>::max())) {
+                return std::numeric_limits<Tout>::max();
+            }
+            if (product <= static_cast<Tgain>(std::numeric_limits<Tout>::min())) {
+                return std::numeric_limits<Tout>::min();
+            }
+            return static_cast<Tout>(product);
+        }
+
         Config _cfg;
         Tout _output;
         Tsignal _previousError;
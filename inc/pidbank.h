@@ -0,0 +1,169 @@
+/*
+ * Copyright 2015 Erik Van Hamme
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef PIDBANK_H
+#define PIDBANK_H
+
+#include "pid.h"
+#include "range.h"
+
+#include <cstddef>
+#include <limits>
+#include <type_traits>
+
+namespace ecpp {
+
+/**
+ * @brief The arrays of a PidBank, one element per loop.
+ *
+ * Ranges are stored as separate lower and upper bounds, an unbounded range is stored as -infinity and +infinity so
+ * the kernels can always clamp without a branch.
+ */
+template <typename T>
+struct PidBankArrays {
+    const T *setPoint;
+    const T *p;
+    const T *i;
+    const T *d;
+    const T *outFrom;
+    const T *outTo;
+    const T *pFrom;
+    const T *pTo;
+    const T *iFrom;
+    const T *iTo;
+    const T *dFrom;
+    const T *dTo;
+    T *previousError;
+    T *accumulatedError;
+    T *output;
+};
+
+/**
+ * @brief Runs one Pid::update step for count loops, using the widest vector kernel the processor supports.
+ */
+void pidBankUpdate(const PidBankArrays<float> &arrays, const float *signals, std::size_t count);
+
+void pidBankUpdate(const PidBankArrays<double> &arrays, const double *signals, std::size_t count);
+
+/**
+ * @brief N floating point PID loops that are all updated in one call.
+ *
+ * Every setting and state variable is kept in its own array (structure of arrays), so one update steps through all
+ * loops with vector instructions. Each loop computes exactly what a Pid<T, T, T> with the same Config computes, in the
+ * same order of operations, as long as both are built with the same floating point contraction settings.
+ */
+template <std::size_t N, typename T = float>
+class PidBank {
+public:
+
+    static_assert(std::is_same<T, float>::value || std::is_same<T, double>::value, "PidBank requires float or double.");
+    static_assert(N > 0, "PidBank needs at least one loop.");
+
+    typedef typename Pid<T, T, T>::Config Config;
+
+    /**
+     * @brief Creates N loops with all gains 0 and unbounded ranges.
+     */
+    PidBank() {
+        for (std::size_t loop = 0; loop < N; ++loop) {
+            _setPoint[loop] = 0;
+            _p[loop] = 0;
+            _i[loop] = 0;
+            _d[loop] = 0;
+            setBounds(Range<T>(0, 0), _outFrom[loop], _outTo[loop]);
+            setBounds(Range<T>(0, 0), _pFrom[loop], _pTo[loop]);
+            setBounds(Range<T>(0, 0), _iFrom[loop], _iTo[loop]);
+            setBounds(Range<T>(0, 0), _dFrom[loop], _dTo[loop]);
+        }
+        reset();
+    }
+
+    static constexpr std::size_t size() {
+        return N;
+    }
+
+    void configure(std::size_t loop, const Config &cfg) {
+        _setPoint[loop] = cfg.setPoint;
+        _p[loop] = cfg.p;
+        _i[loop] = cfg.i;
+        _d[loop] = cfg.d;
+        setBounds(cfg.outRange, _outFrom[loop], _outTo[loop]);
+        setBounds(cfg.pRange, _pFrom[loop], _pTo[loop]);
+        setBounds(cfg.iRange, _iFrom[loop], _iTo[loop]);
+        setBounds(cfg.dRange, _dFrom[loop], _dTo[loop]);
+    }
+
+    void reset() {
+        for (std::size_t loop = 0; loop < N; ++loop) {
+            reset(loop);
+        }
+    }
+
+    void reset(std::size_t loop) {
+        _output[loop] = 0;
+        _previousError[loop] = 0;
+        _accumulatedError[loop] = 0;
+    }
+
+    /**
+     * @brief Updates every loop, signals holds one measurement per loop.
+     */
+    void update(const T *signals) {
+        PidBankArrays<T> arrays = {_setPoint, _p, _i, _d, _outFrom, _outTo, _pFrom, _pTo, _iFrom, _iTo, _dFrom, _dTo,
+                _previousError, _accumulatedError, _output};
+        pidBankUpdate(arrays, signals, N);
+    }
+
+    const T &output(std::size_t loop) const {
+        return _output[loop];
+    }
+
+    const T *outputs() const {
+        return _output;
+    }
+
+private:
+    // Applying these bounds gives the same result as Range::apply, including the 0, 0 range that does not limit.
+    static void setBounds(const Range<T> &range, T &from, T &to) {
+        if ((range.getFrom() == 0) && (range.getTo() == 0)) {
+            from = -std::numeric_limits<T>::infinity();
+            to = std::numeric_limits<T>::infinity();
+        } else {
+            from = range.getFrom();
+            to = range.getTo();
+        }
+    }
+
+    alignas(64) T _setPoint[N];
+    alignas(64) T _p[N];
+    alignas(64) T _i[N];
+    alignas(64) T _d[N];
+    alignas(64) T _outFrom[N];
+    alignas(64) T _outTo[N];
+    alignas(64) T _pFrom[N];
+    alignas(64) T _pTo[N];
+    alignas(64) T _iFrom[N];
+    alignas(64) T _iTo[N];
+    alignas(64) T _dFrom[N];
+    alignas(64) T _dTo[N];
+    alignas(64) T _previousError[N];
+    alignas(64) T _accumulatedError[N];
+    alignas(64) T _output[N];
+};
+
+} // ecpp
+
+#endif // PIDBANK_H
@@ -31,6 +31,7 @@ public:
 
     virtual void *allocate(std::size_t size) override;
     virtual void deallocate(void *address) override;
+    virtual bool resize(void *address, std::size_t size) override;
 
 private:
     int findFreeBlocks(std::size_t blocksNeeded) const;
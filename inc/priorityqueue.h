@@ -0,0 +1,328 @@
+/*
+ * Copyright 2015 Erik Van Hamme
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef PRIORITYQUEUE_H
+#define PRIORITYQUEUE_H
+
+#include "allocator.h"
+#include "comparator.h"
+
+#include <cstddef>
+#include <new>
+#include <utility>
+
+namespace ecpp {
+
+/**
+ * @brief Fixed capacity priority queue, implemented as a D-ary heap in one contiguous array.
+ *
+ * The item at the top is the one that sorts first according to the comparator, so with a LessThanComparator the
+ * smallest item is at the top. Tcomparator can be Comparator<T> to pick a comparator at runtime, or a concrete
+ * comparator type (any type with a compatible compare method) so the compiler can inline the comparisons. An abstract
+ * comparator type is kept by reference and the comparator must outlive the queue, any other one is copied into it.
+ *
+ * Every pushed item gets a handle that stays valid until the item leaves the queue. The handle can be used to change
+ * the priority of the item (decrease-key) or to remove it, both in O(log n).
+ *
+ * If the allocator cannot provide the memory, the queue ends up with a capacity of 0 and every push fails.
+ */
+template <typename T, typename Tcomparator = Comparator<T>, std::size_t D = 4>
+class PriorityQueue {
+public:
+
+    static_assert(D >= 2, "A heap needs at least 2 children per node.");
+
+    typedef std::size_t Handle;
+
+    static constexpr Handle INVALID_HANDLE = static_cast<Handle>(-1);
+
+    PriorityQueue(Allocator &allocator, std::size_t capacity, const Tcomparator &comparator) : _allocator(allocator),
+            _comparator(comparator), _nodes(nullptr), _positions(nullptr), _capacity(0), _size(0), _freeHandle(0) {
+
+        if (capacity == 0) {
+            return;
+        }
+
+        void *mem = _allocator.allocate((sizeof(Node) + sizeof(std::size_t)) * capacity);
+        if (mem == nullptr) {
+            return;
+        }
+
+        _nodes = static_cast<Node *>(mem);
+        _positions = reinterpret_cast<std::size_t *>(_nodes + capacity);
+        _capacity = capacity;
+
+        // All handles start out in the free list.
+        for (std::size_t i = 0; i < _capacity; ++i) {
+            _positions[i] = FREE | (i + 1);
+        }
+    }
+
+    ~PriorityQueue() {
+        if (_nodes != nullptr) {
+            clear();
+            _allocator.deallocate(_nodes);
+        }
+    }
+
+    PriorityQueue(const PriorityQueue &) = delete;
+    PriorityQueue &operator =(const PriorityQueue &) = delete;
+
+    std::size_t capacity() const {
+        return _capacity;
+    }
+
+    std::size_t size() const {
+        return _size;
+    }
+
+    bool empty() const {
+        return _size == 0;
+    }
+
+    /**
+     * @brief Adds an item to the queue.
+     *
+     * @return The handle of the item, or INVALID_HANDLE if the queue is full.
+     */
+    Handle push(const T &item) {
+        if (_size == _capacity) {
+            return INVALID_HANDLE;
+        }
+
+        Handle handle = _freeHandle;
+        _freeHandle = _positions[handle] & ~FREE;
+
+        new (&_nodes[_size]) Node(item, handle);
+        _positions[handle] = _size;
+        ++_size;
+
+        siftUp(_size - 1);
+
+        return handle;
+    }
+
+    /**
+     * @brief Returns the item at the top of the queue, the queue must not be empty.
+     */
+    const T &top() const {
+        return _nodes[0].item;
+    }
+
+    /**
+     * @brief Returns the handle of the item at the top of the queue, or INVALID_HANDLE if the queue is empty.
+     */
+    Handle topHandle() const {
+        return (_size != 0) ? _nodes[0].handle : INVALID_HANDLE;
+    }
+
+    /**
+     * @brief Removes the item at the top of the queue.
+     *
+     * @return True if an item was removed, false if the queue was empty.
+     */
+    bool pop() {
+        if (_size == 0) {
+            return false;
+        }
+
+        removeAt(0);
+
+        return true;
+    }
+
+    /**
+     * @brief Moves the item at the top of the queue out into item and removes it.
+     *
+     * @return True if an item was removed, false if the queue was empty.
+     */
+    bool pop(T &item) {
+        if (_size == 0) {
+            return false;
+        }
+
+        item = std::move(_nodes[0].item);
+        removeAt(0);
+
+        return true;
+    }
+
+    bool contains(Handle handle) const {
+        return (handle < _capacity) && ((_positions[handle] & FREE) == 0);
+    }
+
+    /**
+     * @brief Returns the item with the given handle, the handle must be in the queue.
+     */
+    const T &get(Handle handle) const {
+        return _nodes[_positions[handle]].item;
+    }
+
+    /**
+     * @brief Replaces the item with the given handle and restores the heap order.
+     *
+     * This covers decrease-key as well as moving an item further away from the top.
+     *
+     * @return True on success, false if the handle is not in the queue.
+     */
+    bool update(Handle handle, const T &item) {
+        if (contains(handle) == false) {
+            return false;
+        }
+
+        std::size_t position = _positions[handle];
+        bool towardsTop = before(item, _nodes[position].item);
+
+        _nodes[position].item = item;
+
+        if (towardsTop == true) {
+            siftUp(position);
+        } else {
+            siftDown(position);
+        }
+
+        return true;
+    }
+
+    /**
+     * @brief Removes the item with the given handle.
+     *
+     * @return True on success, false if the handle is not in the queue.
+     */
+    bool erase(Handle handle) {
+        if (contains(handle) == false) {
+            return false;
+        }
+
+        removeAt(_positions[handle]);
+
+        return true;
+    }
+
+    void clear() {
+        while (_size != 0) {
+            removeAt(_size - 1);
+        }
+    }
+
+private:
+    struct Node {
+        Node(const T &i, Handle h) : item(i), handle(h) {
+        }
+
+        T item;
+        Handle handle;
+    };
+
+    // Marks a handle that is not in use, the other bits link the free handles together.
+    static constexpr std::size_t FREE = ~(static_cast<std::size_t>(-1) >> 1);
+
+    bool before(const T &a, const T &b) const {
+        return _comparator.compare(a, b) > 0;
+    }
+
+    void place(std::size_t position, Node &&node) {
+        _nodes[position] = std::move(node);
+        _positions[_nodes[position].handle] = position;
+    }
+
+    // Moves the node at position up, shifting parents down into the hole instead of swapping.
+    void siftUp(std::size_t position) {
+        Node node = std::move(_nodes[position]);
+
+        while (position != 0) {
+            std::size_t parent = (position - 1) / D;
+            if (before(node.item, _nodes[parent].item) == false) {
+                break;
+            }
+            place(position, std::move(_nodes[parent]));
+            position = parent;
+        }
+
+        place(position, std::move(node));
+    }
+
+    // Moves the node at position down, shifting the first child up into the hole instead of swapping.
+    void siftDown(std::size_t position) {
+        Node node = std::move(_nodes[position]);
+
+        for (;;) {
+            std::size_t firstChild = (D * position) + 1;
+            if (firstChild >= _size) {
+                break;
+            }
+
+            std::size_t lastChild = firstChild + D;
+            if (lastChild > _size) {
+                lastChild = _size;
+            }
+
+            std::size_t best = firstChild;
+            for (std::size_t child = firstChild + 1; child < lastChild; ++child) {
+                if (before(_nodes[child].item, _nodes[best].item) == true) {
+                    best = child;
+                }
+            }
+
+            if (before(_nodes[best].item, node.item) == false) {
+                break;
+            }
+
+            place(position, std::move(_nodes[best]));
+            position = best;
+        }
+
+        place(position, std::move(node));
+    }
+
+    void removeAt(std::size_t position) {
+        Handle handle = _nodes[position].handle;
+        std::size_t last = _size - 1;
+
+        if (position != last) {
+            // Nothing is above the root, and pop has already moved its item out, so it must not be compared.
+            bool towardsTop = (position != 0) && before(_nodes[last].item, _nodes[position].item);
+
+            place(position, std::move(_nodes[last]));
+            _nodes[last].~Node();
+            --_size;
+
+            if (towardsTop == true) {
+                siftUp(position);
+            } else {
+                siftDown(position);
+            }
+        } else {
+            _nodes[last].~Node();
+            --_size;
+        }
+
+        _positions[handle] = FREE | _freeHandle;
+        _freeHandle = handle;
+    }
+
+    Allocator &_allocator;
+    typename ComparatorStorage<Tcomparator>::type _comparator;
+    Node *_nodes;
+    std::size_t *_positions;
+    std::size_t _capacity;
+    std::size_t _size;
+    Handle _freeHandle;
+};
+
+} // ecpp
+
+#endif // PRIORITYQUEUE_H
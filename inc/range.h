@@ -17,10 +17,61 @@
 #ifndef RANGE
 #define RANGE
 
+#include <cstddef>
+#include <cstdint>
+#include <limits>
 #include <type_traits>
 
 namespace ecpp {
 
+/**
+ * @brief Clamps count values in place between from and to, with the widest vector kernel the processor supports.
+ *
+ * Every value gets the result of Range::apply for a range that limits, including for from > to and NaN values.
+ */
+void rangeClampArray(std::int8_t *values, std::size_t count, std::int8_t from, std::int8_t to);
+void rangeClampArray(std::int16_t *values, std::size_t count, std::int16_t from, std::int16_t to);
+void rangeClampArray(std::int32_t *values, std::size_t count, std::int32_t from, std::int32_t to);
+void rangeClampArray(std::int64_t *values, std::size_t count, std::int64_t from, std::int64_t to);
+void rangeClampArray(std::uint8_t *values, std::size_t count, std::uint8_t from, std::uint8_t to);
+void rangeClampArray(std::uint16_t *values, std::size_t count, std::uint16_t from, std::uint16_t to);
+void rangeClampArray(std::uint32_t *values, std::size_t count, std::uint32_t from, std::uint32_t to);
+void rangeClampArray(std::uint64_t *values, std::size_t count, std::uint64_t from, std::uint64_t to);
+void rangeClampArray(float *values, std::size_t count, float from, float to);
+void rangeClampArray(double *values, std::size_t count, double from, double to);
+
+/**
+ * @brief Returns true if from <= value <= to for all count values.
+ */
+bool rangeContainsArray(const std::int8_t *values, std::size_t count, std::int8_t from, std::int8_t to);
+bool rangeContainsArray(const std::int16_t *values, std::size_t count, std::int16_t from, std::int16_t to);
+bool rangeContainsArray(const std::int32_t *values, std::size_t count, std::int32_t from, std::int32_t to);
+bool rangeContainsArray(const std::int64_t *values, std::size_t count, std::int64_t from, std::int64_t to);
+bool rangeContainsArray(const std::uint8_t *values, std::size_t count, std::uint8_t from, std::uint8_t to);
+bool rangeContainsArray(const std::uint16_t *values, std::size_t count, std::uint16_t from, std::uint16_t to);
+bool rangeContainsArray(const std::uint32_t *values, std::size_t count, std::uint32_t from, std::uint32_t to);
+bool rangeContainsArray(const std::uint64_t *values, std::size_t count, std::uint64_t from, std::uint64_t to);
+bool rangeContainsArray(const float *values, std::size_t count, float from, float to);
+bool rangeContainsArray(const double *values, std::size_t count, double from, double to);
+
+// Fallbacks for the arithmetic types without a kernel, such as char, bool and long double.
+template <typename T>
+void rangeClampArray(T *values, std::size_t count, T from, T to) {
+    for (std::size_t i = 0; i < count; ++i) {
+        T limited = (to < values[i]) ? to : values[i];
+        values[i] = (values[i] < from) ? from : limited;
+    }
+}
+
+template <typename T>
+bool rangeContainsArray(const T *values, std::size_t count, T from, T to) {
+    bool contained = true;
+    for (std::size_t i = 0; i < count; ++i) {
+        contained = contained & (from <= values[i]) & (values[i] <= to);
+    }
+    return contained;
+}
+
 template <typename T>
 class Range {
 public:
@@ -42,20 +93,34 @@ public:
         return (((_from == 0) && (_to == 0)) || ((_from <= value) && (value <= _to)));
     }
 
+    constexpr bool isUnbounded() const {
+        return ((_from == 0) && (_to == 0));
+    }
+
     T apply(const T &value) const {
-        if ((_from == 0) && (_to == 0)) {
+        if (isUnbounded()) {
             return value;
         }
 
-        if (value < _from) {
-            return _from;
-        }
+        // Selects instead of branches, these compile to min/max or conditional moves.
+        T limited = (_to < value) ? _to : value;
+        return (value < _from) ? _from : limited;
+    }
 
-        if (_to < value) {
-            return _to;
+    /**
+     * @brief Applies the range to count values in place, with vector instructions for the fixed width types.
+     */
+    void applyArray(T *values, std::size_t count) const {
+        if (isUnbounded() == false) {
+            rangeClampArray(values, count, _from, _to);
         }
+    }
 
-        return value;
+    /**
+     * @brief Returns true if the range contains all count values.
+     */
+    bool containsArray(const T *values, std::size_t count) const {
+        return (isUnbounded() || rangeContainsArray(values, count, _from, _to));
     }
 
 private:
@@ -63,6 +128,45 @@ private:
     T _to;
 };
 
+/**
+ * @brief Range without limits, for code that is templated on the range type.
+ *
+ * Unlike the 0, 0 Range, the lack of limits is known at compile time, so applying it compiles to nothing.
+ */
+template <typename T>
+class UnboundedRange {
+public:
+
+    static_assert(std::is_arithmetic<T>::value, "UnboundedRange class requires arithmetic type.");
+
+    constexpr T getFrom() const {
+        return std::numeric_limits<T>::lowest();
+    }
+
+    constexpr T getTo() const {
+        return std::numeric_limits<T>::max();
+    }
+
+    constexpr bool isUnbounded() const {
+        return true;
+    }
+
+    constexpr bool contains(const T &) const {
+        return true;
+    }
+
+    constexpr T apply(const T &value) const {
+        return value;
+    }
+
+    void applyArray(T *, std::size_t) const {
+    }
+
+    constexpr bool containsArray(const T *, std::size_t) const {
+        return true;
+    }
+};
+
 } // ecpp
 
 #endif // RANGE
@@ -0,0 +1,368 @@
+/*
+ * Copyright 2015 Erik Van Hamme
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef RINGBUFFER_H
+#define RINGBUFFER_H
+
+#include "allocator.h"
+
+#include <atomic>
+#include <cstddef>
+#include <new>
+
+namespace ecpp {
+
+// Producer and consumer state is kept this far apart so the two sides do not share a cache line.
+static constexpr std::size_t RING_BUFFER_CACHE_LINE_SIZE = 64;
+
+/**
+ * @brief Bounded queue for exactly one producer thread and one consumer thread.
+ *
+ * The elements live in a caller supplied buffer or in one block taken from an Allocator, nothing is allocated per
+ * element. The capacity is a power of 2: a caller supplied buffer is used up to the largest power of 2 that fits, a
+ * capacity passed with an Allocator is rounded up. Memory that cannot be obtained leaves a capacity of 0.
+ */
+template <typename T>
+class SpscRingBuffer {
+public:
+    SpscRingBuffer(void *mem, std::size_t memSize) : _allocator(nullptr) {
+        std::size_t capacity = 1;
+        while ((capacity * 2 * sizeof(T)) <= memSize) {
+            capacity *= 2;
+        }
+        init(mem, (sizeof(T) <= memSize) ? capacity : 0);
+    }
+
+    SpscRingBuffer(Allocator &allocator, std::size_t capacity) : _allocator(&allocator) {
+        std::size_t rounded = 1;
+        while (rounded < capacity) {
+            rounded *= 2;
+        }
+        void *mem = (capacity != 0) ? allocator.allocate(sizeof(T) * rounded) : nullptr;
+        init(mem, (mem != nullptr) ? rounded : 0);
+    }
+
+    ~SpscRingBuffer() {
+        for (std::size_t i = 0; i < capacity(); ++i) {
+            _items[i].~T();
+        }
+        if ((_allocator != nullptr) && (_items != nullptr)) {
+            _allocator->deallocate(_items);
+        }
+    }
+
+    SpscRingBuffer(const SpscRingBuffer &) = delete;
+    SpscRingBuffer &operator =(const SpscRingBuffer &) = delete;
+
+    std::size_t capacity() const {
+        return (_items != nullptr) ? (_mask + 1) : 0;
+    }
+
+    /**
+     * @brief Returns the number of queued items, this is only a snapshot while the other side is active.
+     */
+    std::size_t size() const {
+        return _head.load(std::memory_order_acquire) - _tail.load(std::memory_order_acquire);
+    }
+
+    /**
+     * @brief Queues one item, must only be called from the producer thread.
+     *
+     * @return True on success, false if the queue is full.
+     */
+    bool push(const T &item) {
+        return push(&item, 1) == 1;
+    }
+
+    /**
+     * @brief Queues up to count items, must only be called from the producer thread.
+     *
+     * @return The number of items that were queued, from the start of items.
+     */
+    std::size_t push(const T *items, std::size_t count) {
+        std::size_t head = _head.load(std::memory_order_relaxed);
+
+        // Only look at the index of the consumer when the cached copy says there is not enough room.
+        std::size_t free = capacity() - (head - _cachedTail);
+        if (free < count) {
+            _cachedTail = _tail.load(std::memory_order_acquire);
+            free = capacity() - (head - _cachedTail);
+            if (count > free) {
+                count = free;
+            }
+        }
+
+        for (std::size_t i = 0; i < count; ++i) {
+            _items[(head + i) & _mask] = items[i];
+        }
+
+        _head.store(head + count, std::memory_order_release);
+
+        return count;
+    }
+
+    /**
+     * @brief Takes one item from the queue, must only be called from the consumer thread.
+     *
+     * @return True on success, false if the queue is empty.
+     */
+    bool pop(T &item) {
+        return pop(&item, 1) == 1;
+    }
+
+    /**
+     * @brief Takes up to count items from the queue, must only be called from the consumer thread.
+     *
+     * @return The number of items that were stored at the start of items.
+     */
+    std::size_t pop(T *items, std::size_t count) {
+        std::size_t tail = _tail.load(std::memory_order_relaxed);
+
+        // Only look at the index of the producer when the cached copy says there are not enough items.
+        std::size_t available = _cachedHead - tail;
+        if (available < count) {
+            _cachedHead = _head.load(std::memory_order_acquire);
+            available = _cachedHead - tail;
+            if (count > available) {
+                count = available;
+            }
+        }
+
+        for (std::size_t i = 0; i < count; ++i) {
+            items[i] = _items[(tail + i) & _mask];
+        }
+
+        _tail.store(tail + count, std::memory_order_release);
+
+        return count;
+    }
+
+private:
+    void init(void *mem, std::size_t capacity) {
+        _items = (capacity != 0) ? static_cast<T *>(mem) : nullptr;
+        _mask = (capacity != 0) ? (capacity - 1) : 0;
+
+        for (std::size_t i = 0; i < capacity; ++i) {
+            new (&_items[i]) T();
+        }
+
+        _head.store(0, std::memory_order_relaxed);
+        _cachedTail = 0;
+        _tail.store(0, std::memory_order_relaxed);
+        _cachedHead = 0;
+    }
+
+    Allocator *_allocator;
+    T *_items;
+    std::size_t _mask;
+
+    // Written by the producer.
+    alignas(RING_BUFFER_CACHE_LINE_SIZE) std::atomic<std::size_t> _head;
+    std::size_t _cachedTail;
+
+    // Written by the consumer.
+    alignas(RING_BUFFER_CACHE_LINE_SIZE) std::atomic<std::size_t> _tail;
+    std::size_t _cachedHead;
+};
+
+/**
+ * @brief Bounded queue for any number of producer and consumer threads.
+ *
+ * Every slot carries a sequence number that tells producers and consumers whose turn it is, so threads only contend on
+ * the shared indices and never block each other while copying an item. Memory is handled as for SpscRingBuffer, use
+ * requiredMemory() to size a caller supplied buffer.
+ */
+template <typename T>
+class MpmcRingBuffer {
+private:
+    struct Cell {
+        std::atomic<std::size_t> sequence;
+        T item;
+    };
+
+public:
+    static constexpr std::size_t requiredMemory(std::size_t capacity) {
+        return sizeof(Cell) * capacity;
+    }
+
+    MpmcRingBuffer(void *mem, std::size_t memSize) : _allocator(nullptr) {
+        std::size_t capacity = 1;
+        while (requiredMemory(capacity * 2) <= memSize) {
+            capacity *= 2;
+        }
+        init(mem, (requiredMemory(1) <= memSize) ? capacity : 0);
+    }
+
+    MpmcRingBuffer(Allocator &allocator, std::size_t capacity) : _allocator(&allocator) {
+        std::size_t rounded = 1;
+        while (rounded < capacity) {
+            rounded *= 2;
+        }
+        void *mem = (capacity != 0) ? allocator.allocate(requiredMemory(rounded)) : nullptr;
+        init(mem, (mem != nullptr) ? rounded : 0);
+    }
+
+    ~MpmcRingBuffer() {
+        for (std::size_t i = 0; i < capacity(); ++i) {
+            _cells[i].~Cell();
+        }
+        if ((_allocator != nullptr) && (_cells != nullptr)) {
+            _allocator->deallocate(_cells);
+        }
+    }
+
+    MpmcRingBuffer(const MpmcRingBuffer &) = delete;
+    MpmcRingBuffer &operator =(const MpmcRingBuffer &) = delete;
+
+    std::size_t capacity() const {
+        return (_cells != nullptr) ? (_mask + 1) : 0;
+    }
+
+    bool push(const T &item) {
+        return push(&item, 1) == 1;
+    }
+
+    /**
+     * @brief Queues up to count items as one contiguous run.
+     *
+     * @return The number of items that were queued, from the start of items.
+     */
+    std::size_t push(const T *items, std::size_t count) {
+        if ((count == 0) || (_cells == nullptr)) {
+            return 0;
+        }
+
+        std::size_t position = _enqueuePosition.load(std::memory_order_relaxed);
+        std::size_t claimed;
+
+        for (;;) {
+
+            // Count the slots from position on that consumers have released for this round.
+            claimed = 0;
+            while ((claimed < count) && (claimed <= _mask)) {
+                std::size_t sequence = _cells[(position + claimed) & _mask].sequence.load(std::memory_order_acquire);
+                if (sequence != (position + claimed)) {
+                    break;
+                }
+                ++claimed;
+            }
+
+            if (claimed == 0) {
+                std::size_t sequence = _cells[position & _mask].sequence.load(std::memory_order_acquire);
+                if (static_cast<std::ptrdiff_t>(sequence - position) < 0) {
+                    // The slot still holds an item of the previous round, the queue is full.
+                    return 0;
+                }
+
+                // Another producer claimed this position already, start over from the new one.
+                position = _enqueuePosition.load(std::memory_order_relaxed);
+                continue;
+            }
+
+            if (_enqueuePosition.compare_exchange_weak(position, position + claimed, std::memory_order_relaxed)) {
+                break;
+            }
+        }
+
+        for (std::size_t i = 0; i < claimed; ++i) {
+            Cell &cell = _cells[(position + i) & _mask];
+            cell.item = items[i];
+            cell.sequence.store(position + i + 1, std::memory_order_release);
+        }
+
+        return claimed;
+    }
+
+    bool pop(T &item) {
+        return pop(&item, 1) == 1;
+    }
+
+    /**
+     * @brief Takes up to count items from the queue as one contiguous run.
+     *
+     * @return The number of items that were stored at the start of items.
+     */
+    std::size_t pop(T *items, std::size_t count) {
+        if ((count == 0) || (_cells == nullptr)) {
+            return 0;
+        }
+
+        std::size_t position = _dequeuePosition.load(std::memory_order_relaxed);
+        std::size_t claimed;
+
+        for (;;) {
+
+            // Count the slots from position on that producers have filled for this round.
+            claimed = 0;
+            while ((claimed < count) && (claimed <= _mask)) {
+                std::size_t sequence = _cells[(position + claimed) & _mask].sequence.load(std::memory_order_acquire);
+                if (sequence != (position + claimed + 1)) {
+                    break;
+                }
+                ++claimed;
+            }
+
+            if (claimed == 0) {
+                std::size_t sequence = _cells[position & _mask].sequence.load(std::memory_order_acquire);
+                if (static_cast<std::ptrdiff_t>(sequence - (position + 1)) < 0) {
+                    // The slot has not been filled for this round yet, the queue is empty.
+                    return 0;
+                }
+
+                // Another consumer claimed this position already, start over from the new one.
+                position = _dequeuePosition.load(std::memory_order_relaxed);
+                continue;
+            }
+
+            if (_dequeuePosition.compare_exchange_weak(position, position + claimed, std::memory_order_relaxed)) {
+                break;
+            }
+        }
+
+        for (std::size_t i = 0; i < claimed; ++i) {
+            Cell &cell = _cells[(position + i) & _mask];
+            items[i] = cell.item;
+            cell.sequence.store(position + i + _mask + 1, std::memory_order_release);
+        }
+
+        return claimed;
+    }
+
+private:
+    void init(void *mem, std::size_t capacity) {
+        _cells = (capacity != 0) ? static_cast<Cell *>(mem) : nullptr;
+        _mask = (capacity != 0) ? (capacity - 1) : 0;
+
+        for (std::size_t i = 0; i < capacity; ++i) {
+            new (&_cells[i]) Cell();
+            _cells[i].sequence.store(i, std::memory_order_relaxed);
+        }
+
+        _enqueuePosition.store(0, std::memory_order_relaxed);
+        _dequeuePosition.store(0, std::memory_order_relaxed);
+    }
+
+    Allocator *_allocator;
+    Cell *_cells;
+    std::size_t _mask;
+
+    alignas(RING_BUFFER_CACHE_LINE_SIZE) std::atomic<std::size_t> _enqueuePosition;
+    alignas(RING_BUFFER_CACHE_LINE_SIZE) std::atomic<std::size_t> _dequeuePosition;
+};
+
+} // ecpp
+
+#endif // RINGBUFFER_H
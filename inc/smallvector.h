@@ -0,0 +1,323 @@
+/*
+ * Copyright 2015 Erik Van Hamme
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SMALLVECTOR_H
+#define SMALLVECTOR_H
+
+#include "allocator.h"
+
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace ecpp {
+
+/**
+ * @brief Contiguous sequence of items, shared by SmallVector and StaticVector.
+ *
+ * Tderived provides grow(n), which must make room for at least n items and return false if it cannot.
+ */
+template <typename T, typename Tderived>
+class VectorBase {
+public:
+    std::size_t size() const {
+        return _size;
+    }
+
+    std::size_t capacity() const {
+        return _capacity;
+    }
+
+    bool empty() const {
+        return _size == 0;
+    }
+
+    T *data() {
+        return _data;
+    }
+
+    const T *data() const {
+        return _data;
+    }
+
+    T *begin() {
+        return _data;
+    }
+
+    const T *begin() const {
+        return _data;
+    }
+
+    T *end() {
+        return _data + _size;
+    }
+
+    const T *end() const {
+        return _data + _size;
+    }
+
+    T &operator [](std::size_t pos) {
+        return _data[pos];
+    }
+
+    const T &operator [](std::size_t pos) const {
+        return _data[pos];
+    }
+
+    bool append(const T &item) {
+        return emplace(item);
+    }
+
+    bool append(T &&item) {
+        return emplace(std::move(item));
+    }
+
+    /**
+     * @brief Constructs a new item at the end of the sequence.
+     *
+     * @return True on success, false if there was no room for the item.
+     */
+    template <typename... X>
+    bool emplace(X &&... x) {
+        if ((_size == _capacity) && (derived().grow(_size + 1) == false)) {
+            return false;
+        }
+
+        new (_data + _size) T(std::forward<X>(x)...);
+        ++_size;
+
+        return true;
+    }
+
+    /**
+     * @brief Removes the last item.
+     *
+     * @return True on success, false if the sequence was empty.
+     */
+    bool removeLast() {
+        if (_size == 0) {
+            return false;
+        }
+
+        --_size;
+        _data[_size].~T();
+
+        return true;
+    }
+
+    void clear() {
+        while (_size != 0) {
+            --_size;
+            _data[_size].~T();
+        }
+    }
+
+    /**
+     * @brief Makes room for at least n items.
+     *
+     * @return True on success, false if there is no room for n items.
+     */
+    bool reserve(std::size_t n) {
+        return (n <= _capacity) || derived().grow(n);
+    }
+
+protected:
+    VectorBase(T *data, std::size_t capacity) : _data(data), _size(0), _capacity(capacity) {
+    }
+
+    ~VectorBase() {
+        clear();
+    }
+
+    // Moves the items of other behind the current items, other is left empty. The room must be there already.
+    void moveItemsFrom(VectorBase &other) {
+        for (std::size_t i = 0; i < other._size; ++i) {
+            new (_data + _size) T(std::move(other._data[i]));
+            ++_size;
+        }
+        other.clear();
+    }
+
+    T *_data;
+    std::size_t _size;
+    std::size_t _capacity;
+
+private:
+    Tderived &derived() {
+        return *static_cast<Tderived *>(this);
+    }
+};
+
+/**
+ * @brief Sequence of up to N items that lives entirely inside the object and never allocates.
+ */
+template <typename T, std::size_t N>
+class StaticVector : public VectorBase<T, StaticVector<T, N>> {
+public:
+
+    static_assert(N > 0, "StaticVector needs room for at least one item.");
+
+    StaticVector() : VectorBase<T, StaticVector<T, N>>(nullptr, N) {
+        this->_data = reinterpret_cast<T *>(&_storage);
+    }
+
+    StaticVector(StaticVector &&other) : VectorBase<T, StaticVector<T, N>>(nullptr, N) {
+        this->_data = reinterpret_cast<T *>(&_storage);
+        this->moveItemsFrom(other);
+    }
+
+    StaticVector &operator =(StaticVector &&other) {
+        if (&other != this) {
+            this->clear();
+            this->moveItemsFrom(other);
+        }
+        return *this;
+    }
+
+    StaticVector(const StaticVector &) = delete;
+    StaticVector &operator =(const StaticVector &) = delete;
+
+private:
+    bool grow(std::size_t n) {
+        (void) n;
+        return false;
+    }
+
+    typename std::aligned_storage<sizeof(T) * N, alignof(T)>::type _storage;
+
+    friend class VectorBase<T, StaticVector<T, N>>;
+};
+
+/**
+ * @brief Sequence that keeps up to N items inside the object and moves to memory from an Allocator beyond that.
+ *
+ * When the items are already in allocator memory, growing first tries to extend the allocation in place through
+ * Allocator::resize so the items do not have to be moved.
+ */
+template <typename T, std::size_t N>
+class SmallVector : public VectorBase<T, SmallVector<T, N>> {
+public:
+
+    static_assert(N > 0, "SmallVector needs room for at least one inline item.");
+
+    SmallVector(Allocator &allocator) : VectorBase<T, SmallVector<T, N>>(nullptr, N), _allocator(&allocator) {
+        this->_data = inlineData();
+    }
+
+    /**
+     * @brief Takes over the items of other, together with its allocator. Items in allocator memory are not moved.
+     */
+    SmallVector(SmallVector &&other) : VectorBase<T, SmallVector<T, N>>(nullptr, N), _allocator(other._allocator) {
+        this->_data = inlineData();
+        takeFrom(other);
+    }
+
+    SmallVector &operator =(SmallVector &&other) {
+        if (&other != this) {
+            this->clear();
+            release();
+            _allocator = other._allocator;
+            takeFrom(other);
+        }
+        return *this;
+    }
+
+    SmallVector(const SmallVector &) = delete;
+    SmallVector &operator =(const SmallVector &) = delete;
+
+    ~SmallVector() {
+        this->clear();
+        release();
+    }
+
+    /**
+     * @brief Returns true while the items are stored inside the object.
+     */
+    bool isInline() const {
+        return this->_data == inlineData();
+    }
+
+private:
+    T *inlineData() {
+        return reinterpret_cast<T *>(&_storage);
+    }
+
+    const T *inlineData() const {
+        return reinterpret_cast<const T *>(&_storage);
+    }
+
+    bool grow(std::size_t n) {
+        std::size_t capacity = this->_capacity * 2;
+        if (capacity < n) {
+            capacity = n;
+        }
+
+        if ((isInline() == false) && (_allocator->resize(this->_data, sizeof(T) * capacity) == true)) {
+            this->_capacity = capacity;
+            return true;
+        }
+
+        T *data = static_cast<T *>(_allocator->allocate(sizeof(T) * capacity));
+        if (data == nullptr) {
+            return false;
+        }
+
+        for (std::size_t i = 0; i < this->_size; ++i) {
+            new (data + i) T(std::move(this->_data[i]));
+            this->_data[i].~T();
+        }
+
+        release();
+        this->_data = data;
+        this->_capacity = capacity;
+
+        return true;
+    }
+
+    // Gives allocator memory back and returns to the inline storage, the items must already be gone.
+    void release() {
+        if (isInline() == false) {
+            _allocator->deallocate(this->_data);
+            this->_data = inlineData();
+            this->_capacity = N;
+        }
+    }
+
+    // Takes the items of other, which must use the same allocator as this vector. Other is left empty and inline.
+    void takeFrom(SmallVector &other) {
+        if (other.isInline() == false) {
+            this->_data = other._data;
+            this->_size = other._size;
+            this->_capacity = other._capacity;
+
+            other._data = other.inlineData();
+            other._size = 0;
+            other._capacity = N;
+        } else {
+            this->moveItemsFrom(other);
+        }
+    }
+
+    Allocator *_allocator;
+    typename std::aligned_storage<sizeof(T) * N, alignof(T)>::type _storage;
+
+    friend class VectorBase<T, SmallVector<T, N>>;
+};
+
+} // ecpp
+
+#endif // SMALLVECTOR_H
@@ -0,0 +1,410 @@
+/*
+ * Copyright 2015 Erik Van Hamme
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SORT_H
+#define SORT_H
+
+#include "allocator.h"
+#include "comparator.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+#include <utility>
+
+namespace ecpp {
+
+namespace sorting {
+
+// Arrays up to this size are sorted with a sorting network or insertion sort.
+static constexpr std::size_t SMALL_SIZE = 16;
+
+// Arrays of arithmetic values from this size on are radix sorted, when a stock comparator is used.
+static constexpr std::size_t RADIX_SIZE = 256;
+
+// Predicates that return true if a goes before b.
+template <typename T, typename Tcomparator>
+struct ComparatorBefore {
+    const Tcomparator &comparator;
+
+    bool operator ()(const T &a, const T &b) const {
+        return comparator.compare(a, b) > 0;
+    }
+};
+
+template <typename T>
+struct Less {
+    bool operator ()(const T &a, const T &b) const {
+        return a < b;
+    }
+};
+
+template <typename T>
+struct Greater {
+    bool operator ()(const T &a, const T &b) const {
+        return b < a;
+    }
+};
+
+// The stock comparators are replaced by the plain operators, which the compiler can inline.
+template <typename T, typename Tcomparator>
+ComparatorBefore<T, Tcomparator> before(const Tcomparator &comparator) {
+    return ComparatorBefore<T, Tcomparator> {comparator};
+}
+
+template <typename T>
+Less<T> before(const LessThanComparator<T> &) {
+    return Less<T>();
+}
+
+template <typename T>
+Greater<T> before(const GreaterThanComparator<T> &) {
+    return Greater<T>();
+}
+
+/**
+ * @brief Puts a and b in order with selects instead of a branch, the values are swapped, never duplicated.
+ */
+template <typename T, typename Tbefore>
+inline void compareExchange(T &a, T &b, const Tbefore &before) {
+    bool swap = before(b, a);
+    T first = swap ? b : a;
+    T second = swap ? a : b;
+    a = first;
+    b = second;
+}
+
+/**
+ * @brief Batcher odd-even merge sort network for count values.
+ *
+ * The comparators only depend on count, not on the data, so there are no mispredicted branches. With a constant count
+ * the loops unroll into a straight sequence of compare-exchanges.
+ */
+template <typename T, typename Tbefore>
+inline void network(T *data, std::size_t count, const Tbefore &before) {
+    for (std::size_t p = 1; p < count; p += p) {
+        for (std::size_t k = p; k > 0; k /= 2) {
+            for (std::size_t j = k % p; (j + k) < count; j += (2 * k)) {
+                for (std::size_t i = 0; (i < k) && ((i + j + k) < count); ++i) {
+                    if (((i + j) / (2 * p)) == ((i + j + k) / (2 * p))) {
+                        compareExchange(data[i + j], data[i + j + k], before);
+                    }
+                }
+            }
+        }
+    }
+}
+
+template <typename T, typename Tbefore>
+void insertionSort(T *data, std::size_t count, const Tbefore &before) {
+    for (std::size_t i = 1; i < count; ++i) {
+        T value = std::move(data[i]);
+        std::size_t j = i;
+        while ((j > 0) && before(value, data[j - 1])) {
+            data[j] = std::move(data[j - 1]);
+            --j;
+        }
+        data[j] = std::move(value);
+    }
+}
+
+template <typename T, typename Tbefore>
+void siftDown(T *data, std::size_t position, std::size_t count, const Tbefore &before) {
+    T value = std::move(data[position]);
+    while (true) {
+        std::size_t child = (2 * position) + 1;
+        if (child >= count) {
+            break;
+        }
+        if (((child + 1) < count) && before(data[child], data[child + 1])) {
+            ++child;
+        }
+        if (before(value, data[child]) == false) {
+            break;
+        }
+        data[position] = std::move(data[child]);
+        position = child;
+    }
+    data[position] = std::move(value);
+}
+
+template <typename T, typename Tbefore>
+void heapSort(T *data, std::size_t count, const Tbefore &before) {
+    for (std::size_t i = count / 2; i > 0; --i) {
+        siftDown(data, i - 1, count, before);
+    }
+    for (std::size_t end = count - 1; end > 0; --end) {
+        std::swap(data[0], data[end]);
+        siftDown(data, 0, end, before);
+    }
+}
+
+/**
+ * @brief Quicksort that falls back to heap sort when the recursion gets too deep, and leaves small parts to small.
+ */
+template <typename T, typename Tbefore, typename Tsmall>
+void introSort(T *data, std::size_t count, const Tbefore &before, unsigned int depth, const Tsmall &small) {
+    while (count > SMALL_SIZE) {
+        if (depth == 0) {
+            heapSort(data, count, before);
+            return;
+        }
+        --depth;
+
+        // Median of three as pivot, not the last element so both parts are non-empty.
+        std::size_t middle = (count - 1) / 2;
+        compareExchange(data[0], data[middle], before);
+        compareExchange(data[middle], data[count - 1], before);
+        compareExchange(data[0], data[middle], before);
+        T pivot = data[middle];
+
+        // Hoare partition: [0, j] does not go after the pivot, [j + 1, count) does not go before it.
+        std::ptrdiff_t i = -1;
+        std::ptrdiff_t j = static_cast<std::ptrdiff_t>(count);
+        while (true) {
+            do {
+                ++i;
+            } while (before(data[i], pivot));
+            do {
+                --j;
+            } while (before(pivot, data[j]));
+            if (i >= j) {
+                break;
+            }
+            std::swap(data[i], data[j]);
+        }
+
+        // Recurses into the smaller part and loops on the larger one, this bounds the stack depth.
+        std::size_t left = static_cast<std::size_t>(j) + 1;
+        if (left < (count - left)) {
+            introSort(data, left, before, depth, small);
+            data += left;
+            count -= left;
+        } else {
+            introSort(data + left, count - left, before, depth, small);
+            count = left;
+        }
+    }
+
+    small(data, count, before);
+}
+
+struct NetworkSort {
+    template <typename T, typename Tbefore>
+    void operator ()(T *data, std::size_t count, const Tbefore &before) const {
+        network(data, count, before);
+    }
+};
+
+struct InsertionSort {
+    template <typename T, typename Tbefore>
+    void operator ()(T *data, std::size_t count, const Tbefore &before) const {
+        insertionSort(data, count, before);
+    }
+};
+
+inline unsigned int depthLimit(std::size_t count) {
+    unsigned int depth = 0;
+    for (; count > 1; count >>= 1) {
+        depth += 2;
+    }
+    return depth;
+}
+
+/**
+ * @brief Maps values of T to unsigned keys with the same order, for radix sorting.
+ */
+template <typename T>
+struct RadixKey {
+    typedef typename std::conditional<sizeof(T) == 1, std::uint8_t,
+            typename std::conditional<sizeof(T) == 2, std::uint16_t,
+            typename std::conditional<sizeof(T) == 4, std::uint32_t, std::uint64_t>::type>::type>::type Key;
+
+    static constexpr Key SIGN = static_cast<Key>(static_cast<Key>(1) << ((8 * sizeof(Key)) - 1));
+
+    static Key key(const T &value) {
+        Key bits;
+        std::memcpy(&bits, &value, sizeof(bits));
+
+        if (std::is_floating_point<T>::value) {
+            // Negative values: all bits flipped, positive values: the sign bit set. -0.0 sorts before 0.0.
+            Key mask = ((bits & SIGN) != 0) ? static_cast<Key>(~static_cast<Key>(0)) : SIGN;
+            return static_cast<Key>(bits ^ mask);
+        }
+        if (std::is_signed<T>::value) {
+            return static_cast<Key>(bits ^ SIGN);
+        }
+        return bits;
+    }
+};
+
+// Integers and floating point types of 1 to 8 bytes, no long double.
+template <typename T>
+struct is_radix_sortable : std::integral_constant<bool, std::is_arithmetic<T>::value && (sizeof(T) <= 8) &&
+        (std::is_integral<T>::value || (std::is_floating_point<T>::value && (sizeof(T) >= 4)))> {
+};
+
+/**
+ * @brief LSD radix sort on bytes, stable, with count values of scratch space and all histograms from one pass.
+ *
+ * Passes where all values have the same byte are skipped, so small integers in a wide type take few passes.
+ */
+template <typename T>
+void radixSort(T *data, std::size_t count, T *scratch, std::size_t *histograms, bool descending) {
+    typedef typename RadixKey<T>::Key Key;
+    static constexpr std::size_t PASSES = sizeof(Key);
+
+    Key flip = descending ? static_cast<Key>(~static_cast<Key>(0)) : 0;
+
+    std::memset(histograms, 0, PASSES * 256 * sizeof(std::size_t));
+    for (std::size_t i = 0; i < count; ++i) {
+        Key key = static_cast<Key>(RadixKey<T>::key(data[i]) ^ flip);
+        for (std::size_t pass = 0; pass < PASSES; ++pass) {
+            ++histograms[(pass * 256) + ((key >> (8 * pass)) & 0xffu)];
+        }
+    }
+
+    T *from = data;
+    T *to = scratch;
+    for (std::size_t pass = 0; pass < PASSES; ++pass) {
+        std::size_t *histogram = histograms + (pass * 256);
+
+        Key firstKey = static_cast<Key>(RadixKey<T>::key(from[0]) ^ flip);
+        if (histogram[(firstKey >> (8 * pass)) & 0xffu] == count) {
+            continue;
+        }
+
+        // Histogram to the start offset of every bucket.
+        std::size_t offset = 0;
+        for (std::size_t digit = 0; digit < 256; ++digit) {
+            std::size_t size = histogram[digit];
+            histogram[digit] = offset;
+            offset += size;
+        }
+
+        for (std::size_t i = 0; i < count; ++i) {
+            Key key = static_cast<Key>(RadixKey<T>::key(from[i]) ^ flip);
+            to[histogram[(key >> (8 * pass)) & 0xffu]++] = from[i];
+        }
+        std::swap(from, to);
+    }
+
+    if (from != data) {
+        std::memcpy(data, from, count * sizeof(T));
+    }
+}
+
+template <typename T>
+void sortArithmetic(T *data, std::size_t count, bool descending, Allocator &allocator, std::true_type) {
+    if (count >= RADIX_SIZE) {
+        typedef typename RadixKey<T>::Key Key;
+        std::size_t histogramBytes = sizeof(Key) * 256 * sizeof(std::size_t);
+
+        void *mem = allocator.allocate(histogramBytes + (count * sizeof(T)));
+        if (mem != nullptr) {
+            std::size_t *histograms = static_cast<std::size_t *>(mem);
+            T *scratch = reinterpret_cast<T *>(static_cast<std::uint8_t *>(mem) + histogramBytes);
+            radixSort(data, count, scratch, histograms, descending);
+            allocator.deallocate(mem);
+            return;
+        }
+    }
+
+    // Small arrays, or no scratch space.
+    if (descending == true) {
+        introSort(data, count, Greater<T>(), depthLimit(count), NetworkSort());
+    } else {
+        introSort(data, count, Less<T>(), depthLimit(count), NetworkSort());
+    }
+}
+
+template <typename T>
+void sortArithmetic(T *data, std::size_t count, bool descending, Allocator &, std::false_type) {
+    if (descending == true) {
+        introSort(data, count, Greater<T>(), depthLimit(count), NetworkSort());
+    } else {
+        introSort(data, count, Less<T>(), depthLimit(count), NetworkSort());
+    }
+}
+
+inline Allocator &defaultAllocator() {
+    static Allocator allocator;
+    return allocator;
+}
+
+} // sorting
+
+/**
+ * @brief Sorts count values in place, so that for every pair a before b, compare(b, a) is not positive.
+ *
+ * This is an introsort: O(n log n) comparisons in the worst case, not stable. The comparator must never report a
+ * value as coming before itself.
+ */
+template <typename T, typename Tcomparator>
+void sort(T *data, std::size_t count, const Tcomparator &comparator) {
+    sorting::introSort(data, count, sorting::before<T>(comparator), sorting::depthLimit(count), sorting::InsertionSort());
+}
+
+template <typename T, typename Tcomparator>
+void sort(T *data, std::size_t count, const Tcomparator &comparator, Allocator &) {
+    sort(data, count, comparator);
+}
+
+/**
+ * @brief Sorts arithmetic values in ascending order, radix sorted when there are many.
+ *
+ * The comparator is only used for its type, the static type has to be LessThanComparator for this overload to be
+ * picked, a Comparator reference is sorted by comparisons. Large arrays take count values of scratch memory from
+ * allocator, they are sorted by comparisons if that fails. Small arrays are finished with a sorting network.
+ *
+ * The radix sort orders floating point values by their bits: -0.0 before 0.0, NaNs with the sign bit set first and
+ * the other NaNs last.
+ */
+template <typename T>
+void sort(T *data, std::size_t count, const LessThanComparator<T> &, Allocator &allocator) {
+    sorting::sortArithmetic(data, count, false, allocator, sorting::is_radix_sortable<T>());
+}
+
+/**
+ * @brief Sorts arithmetic values in descending order, as the LessThanComparator overload.
+ */
+template <typename T>
+void sort(T *data, std::size_t count, const GreaterThanComparator<T> &, Allocator &allocator) {
+    sorting::sortArithmetic(data, count, true, allocator, sorting::is_radix_sortable<T>());
+}
+
+template <typename T>
+void sort(T *data, std::size_t count, const LessThanComparator<T> &comparator) {
+    sort(data, count, comparator, sorting::defaultAllocator());
+}
+
+template <typename T>
+void sort(T *data, std::size_t count, const GreaterThanComparator<T> &comparator) {
+    sort(data, count, comparator, sorting::defaultAllocator());
+}
+
+/**
+ * @brief Sorts exactly N values with a sorting network, branch free and fully unrolled for small N.
+ */
+template <std::size_t N, typename T, typename Tcomparator>
+void sortFixed(T *data, const Tcomparator &comparator) {
+    sorting::network(data, N, sorting::before<T>(comparator));
+}
+
+} // ecpp
+
+#endif // SORT_H
@@ -0,0 +1,221 @@
+/*
+ * Copyright 2015 Erik Van Hamme
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef TASKPOOL_H
+#define TASKPOOL_H
+
+#include "allocator.h"
+
+#include <atomic>
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace ecpp {
+
+class TaskGroup;
+
+/**
+ * @brief Thread pool with a work-stealing deque per worker, for fork/join parallelism.
+ *
+ * Work is added through a TaskGroup or parallelFor. A worker pushes the tasks it spawns onto its own Chase-Lev deque
+ * and pops them back in LIFO order. Idle workers steal from the other end of the deques of other workers. Threads
+ * outside the pool hand their tasks over through a shared queue and help running tasks while they wait.
+ *
+ * Every task lives in a slot of TASK_SIZE bytes, so the callable of a task can be at most TASK_STORAGE bytes.
+ * Slots come from the allocator the first time and are then recycled through per-worker free lists, so a steady
+ * stream of tasks does not allocate. The allocator is only used under a lock and does not have to be thread safe.
+ * When no slot can be allocated or a deque is full, the task is run right away by the thread that spawns it.
+ */
+class TaskPool {
+public:
+    static constexpr std::size_t TASK_SIZE = 64;
+    static constexpr std::size_t TASK_STORAGE = TASK_SIZE - (3 * sizeof(void *));
+
+    /**
+     * @brief Starts the workers.
+     *
+     * @param [in] allocator Provides the workers, their deques and the task slots.
+     * @param [in] workerCount The number of worker threads, 0 for one per hardware thread.
+     * @param [in] dequeCapacity The number of tasks per deque, rounded up to a power of 2.
+     */
+    TaskPool(Allocator &allocator, std::size_t workerCount = 0, std::size_t dequeCapacity = 1024);
+
+    /**
+     * @brief Stops the workers, every TaskGroup must have finished.
+     */
+    ~TaskPool();
+
+    TaskPool(const TaskPool &) = delete;
+    TaskPool &operator =(const TaskPool &) = delete;
+
+    std::size_t workerCount() const {
+        return _workerCount;
+    }
+
+    /**
+     * @brief Calls f(i) for every i in [begin, end), in parallel, and returns when all calls are done.
+     *
+     * The range is split in halves until the parts are at most grain long, the halves become tasks that idle workers
+     * can steal.
+     */
+    template <typename F>
+    void parallelFor(std::size_t begin, std::size_t end, std::size_t grain, const F &f);
+
+private:
+    friend class TaskGroup;
+
+    struct Worker;
+    struct Shared;
+
+    struct Task {
+        void (*invoke)(Task *task);
+        TaskGroup *group;
+        Task *next;
+        typename std::aligned_storage<TASK_STORAGE, alignof(void *)>::type storage;
+    };
+
+    static_assert(sizeof(Task) == TASK_SIZE, "Task slot has padding.");
+
+    template <typename F>
+    struct ForRange {
+        TaskGroup *group;
+        const F *f;
+        std::size_t begin;
+        std::size_t end;
+        std::size_t grain;
+
+        void operator ()() const;
+    };
+
+    Task *acquireTask();
+    void releaseTask(Task *task);
+    bool push(Task *task);
+    void execute(Task *task);
+
+    /**
+     * @brief Runs one task from the own deque, the shared queue or another worker.
+     *
+     * @return True if a task was run.
+     */
+    bool helpOnce();
+
+    Task *findTask(Worker *self);
+    void run(Worker &worker);
+
+    // The worker of this pool that runs on the calling thread, or nullptr.
+    Worker *self() const;
+
+    Allocator &_allocator;
+    Shared *_shared;
+    Worker *_workers;
+    std::size_t _workerCount;
+};
+
+/**
+ * @brief Set of tasks that are waited for together, the fork/join building block of a TaskPool.
+ *
+ * Tasks can be added from any thread, also from within tasks of the same group. wait() helps running tasks until all
+ * tasks of the group are done. The destructor waits as well.
+ */
+class TaskGroup {
+public:
+    TaskGroup(TaskPool &pool) : _pool(pool), _pending(0) {
+    }
+
+    ~TaskGroup() {
+        wait();
+    }
+
+    TaskGroup(const TaskGroup &) = delete;
+    TaskGroup &operator =(const TaskGroup &) = delete;
+
+    /**
+     * @brief Spawns a task that calls f().
+     */
+    template <typename F>
+    void run(F &&f) {
+        typedef typename std::decay<F>::type Callable;
+
+        static_assert(sizeof(Callable) <= TaskPool::TASK_STORAGE, "Callable does not fit in a task slot.");
+        static_assert(alignof(Callable) <= alignof(void *), "Callable alignment is too strict for a task slot.");
+
+        TaskPool::Task *task = _pool.acquireTask();
+        if (task == nullptr) {
+            f();
+            return;
+        }
+
+        new (&task->storage) Callable(std::forward<F>(f));
+        task->invoke = &invoke<Callable>;
+        task->group = this;
+
+        _pending.fetch_add(1, std::memory_order_relaxed);
+        if (_pool.push(task) == false) {
+            _pool.execute(task);
+        }
+    }
+
+    void wait();
+
+private:
+    friend class TaskPool;
+
+    template <typename Tcallable>
+    static void invoke(TaskPool::Task *task) {
+        Tcallable *callable = reinterpret_cast<Tcallable *>(&task->storage);
+        (*callable)();
+        callable->~Tcallable();
+    }
+
+    TaskPool &_pool;
+    std::atomic<std::size_t> _pending;
+};
+
+template <typename F>
+void TaskPool::ForRange<F>::operator ()() const {
+    std::size_t last = end;
+
+    // Keeps the first half and hands the second half out, until the part is small enough.
+    while ((last - begin) > grain) {
+        std::size_t middle = begin + ((last - begin) / 2);
+        group->run(ForRange<F> {group, f, middle, last, grain});
+        last = middle;
+    }
+
+    for (std::size_t i = begin; i < last; ++i) {
+        (*f)(i);
+    }
+}
+
+template <typename F>
+void TaskPool::parallelFor(std::size_t begin, std::size_t end, std::size_t grain, const F &f) {
+    if (begin >= end) {
+        return;
+    }
+    if (grain == 0) {
+        grain = 1;
+    }
+
+    TaskGroup group(*this);
+    ForRange<F> {&group, &f, begin, end, grain}();
+    group.wait();
+}
+
+} // ecpp
+
+#endif // TASKPOOL_H
@@ -0,0 +1,235 @@
+/*
+ * Copyright 2015 Erik Van Hamme
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef TRACEALLOCATOR_H
+#define TRACEALLOCATOR_H
+
+#include "allocator.h"
+
+#include <cstddef>
+#include <cstdint>
+
+namespace ecpp {
+
+enum class AllocationEventType : std::uint8_t {
+    ALLOCATE = 0,
+    ALLOCATE_FAILED = 1,
+    DEALLOCATE = 2,
+    RESIZE = 3,
+    RESIZE_FAILED = 4
+};
+
+/**
+ * @brief One call on a traced allocator.
+ *
+ * The address is the one the traced allocator handed out, it only serves to match deallocations and resizes with
+ * their allocation. The time is in microseconds since the recorder was created and wraps after about 71 minutes.
+ */
+struct AllocationEvent {
+    std::uint64_t address;
+    std::uint32_t size;
+    std::uint32_t time;
+    std::uint16_t tag;
+    AllocationEventType type;
+};
+
+/**
+ * @brief Allocator decorator that records every call into a ring buffer of AllocationEvents.
+ *
+ * Calls are passed on to the target allocator unchanged. When the ring is full the oldest events are overwritten, so
+ * after a failure in the field the ring holds the calls that led up to it. Every event carries the current tag, which
+ * callers set to tell their allocations apart. The recorder itself is not thread safe, calls must be serialised by the
+ * user.
+ *
+ * The ring can be saved to a compact little endian buffer, written to a file and replayed offline with replayTrace.
+ */
+class TraceAllocator : public Allocator {
+public:
+    /**
+     * @brief Records into a caller supplied buffer, that holds memSize / sizeof(AllocationEvent) events.
+     */
+    TraceAllocator(Allocator &target, void *mem, std::size_t memSize);
+
+    /**
+     * @brief Records into a ring of capacity events taken from ringAllocator, capacity 0 if that fails.
+     */
+    TraceAllocator(Allocator &target, Allocator &ringAllocator, std::size_t capacity);
+
+    virtual ~TraceAllocator();
+
+    TraceAllocator(const TraceAllocator &) = delete;
+    TraceAllocator &operator =(const TraceAllocator &) = delete;
+
+    virtual void *allocate(std::size_t size) override;
+    virtual void deallocate(void *address) override;
+    virtual bool resize(void *address, std::size_t size) override;
+
+    /**
+     * @brief Allocates with tag for this one call, without changing the current tag.
+     */
+    void *allocate(std::size_t size, std::uint16_t tag);
+
+    /**
+     * @brief Sets the tag of the events that follow.
+     *
+     * @return The previous tag, to restore it afterwards.
+     */
+    std::uint16_t setTag(std::uint16_t tag) {
+        std::uint16_t previous = _tag;
+        _tag = tag;
+        return previous;
+    }
+
+    std::size_t capacity() const {
+        return _capacity;
+    }
+
+    /**
+     * @brief Returns the number of events in the ring.
+     */
+    std::size_t size() const {
+        return _size;
+    }
+
+    /**
+     * @brief Returns the number of events that were overwritten since the last clear.
+     */
+    std::uint64_t dropped() const {
+        return _dropped;
+    }
+
+    /**
+     * @brief Returns an event, index 0 is the oldest one in the ring.
+     */
+    const AllocationEvent &event(std::size_t index) const {
+        std::size_t position = _first + index;
+        return _events[(position < _capacity) ? position : (position - _capacity)];
+    }
+
+    void clear();
+
+    /**
+     * @brief Returns the number of bytes save needs for count events.
+     */
+    static std::size_t savedSize(std::size_t count);
+
+    /**
+     * @brief Writes the events in the ring to mem, oldest first.
+     *
+     * @return The number of bytes written, 0 if memSize is less than savedSize(size()).
+     */
+    std::size_t save(void *mem, std::size_t memSize) const;
+
+private:
+    void record(AllocationEventType type, const void *address, std::size_t size, std::uint16_t tag);
+
+    Allocator &_target;
+    Allocator *_ringAllocator;
+    AllocationEvent *_events;
+    std::size_t _capacity;
+    std::size_t _first;
+    std::size_t _size;
+    std::uint64_t _dropped;
+    std::uint64_t _start;
+    std::uint16_t _tag;
+};
+
+/**
+ * @brief Read only view on a trace that was saved by TraceAllocator, for example from a MappedFile.
+ */
+class AllocationTrace {
+public:
+    /**
+     * @brief Checks the header, an invalid trace has no events.
+     */
+    AllocationTrace(const void *data, std::size_t size);
+
+    bool isValid() const {
+        return _data != nullptr;
+    }
+
+    std::size_t size() const {
+        return _size;
+    }
+
+    /**
+     * @brief Returns the number of events the recorder overwrote before the trace was saved.
+     */
+    std::uint64_t dropped() const {
+        return _dropped;
+    }
+
+    AllocationEvent event(std::size_t index) const;
+
+private:
+    const std::uint8_t *_data;
+    std::size_t _size;
+    std::uint64_t _dropped;
+};
+
+/**
+ * @brief Outcome of replaying a trace against an allocator, latencies in nanoseconds.
+ */
+struct ReplayResult {
+    static constexpr std::size_t NO_FAILURE = static_cast<std::size_t>(-1);
+
+    // False if the replay could not get its bookkeeping memory, the other fields are then not filled in.
+    bool complete;
+
+    std::size_t allocations;
+    std::size_t deallocations;
+    std::size_t resizes;
+
+    // Allocations that failed on the replay target, and the index of the first one in the trace.
+    std::size_t failures;
+    std::size_t firstFailure;
+
+    // Resizes that succeeded in the recording but not on the replay target.
+    std::size_t resizeFailures;
+
+    // Deallocations and resizes of allocations made before the first event in the trace, these are skipped.
+    std::size_t unmatched;
+
+    // Requested bytes and number of allocations that were live at the same time, at most.
+    std::size_t peakBytes;
+    std::size_t peakCount;
+
+    std::uint64_t allocateP50;
+    std::uint64_t allocateP90;
+    std::uint64_t allocateP99;
+    std::uint64_t allocateMax;
+    std::uint64_t deallocateP50;
+    std::uint64_t deallocateP99;
+    std::uint64_t deallocateMax;
+};
+
+/**
+ * @brief Runs the calls of a trace against target, in order, and measures them.
+ *
+ * Allocations that failed in the recording are tried again and released right away when they succeed, the recorded
+ * program never used them. Allocations that are still live at the end of the trace are released, so target can be
+ * reused for the next replay. The bookkeeping memory, a few words per event, comes from scratch.
+ *
+ * Together with MappedFile and AllocationTrace this is the offline replay tool: a host program maps a saved trace and
+ * replays it against every allocator configuration that is considered.
+ */
+ReplayResult replayTrace(const AllocationEvent *events, std::size_t count, Allocator &target, Allocator &scratch);
+
+ReplayResult replayTrace(const AllocationTrace &trace, Allocator &target, Allocator &scratch);
+
+} // ecpp
+
+#endif // TRACEALLOCATOR_H
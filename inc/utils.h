@@ -19,6 +19,7 @@
 
 #include <cstddef>
 #include <cstdint>
+#include <limits>
 #include <type_traits>
 
 namespace ecpp {
@@ -35,36 +36,414 @@ static void byteSwap(T &subject) {
     }
 }
 
+/**
+ * @brief Returns value with its bytes in reverse order.
+ *
+ * These are constexpr and compile to a single bswap/rev instruction on compilers that provide the builtins.
+ */
+constexpr inline std::uint8_t byteSwapped(std::uint8_t value) {
+    return value;
+}
+
+constexpr inline std::uint16_t byteSwapped(std::uint16_t value) {
+#if defined(__GNUC__)
+    return __builtin_bswap16(value);
+#else
+    return static_cast<std::uint16_t>((value << 8) | (value >> 8));
+#endif
+}
+
+constexpr inline std::uint32_t byteSwapped(std::uint32_t value) {
+#if defined(__GNUC__)
+    return __builtin_bswap32(value);
+#else
+    return (value << 24) | ((value & 0x0000ff00u) << 8) | ((value & 0x00ff0000u) >> 8) | (value >> 24);
+#endif
+}
+
+constexpr inline std::uint64_t byteSwapped(std::uint64_t value) {
+#if defined(__GNUC__)
+    return __builtin_bswap64(value);
+#else
+    return (static_cast<std::uint64_t>(byteSwapped(static_cast<std::uint32_t>(value))) << 32) |
+            byteSwapped(static_cast<std::uint32_t>(value >> 32));
+#endif
+}
+
+constexpr inline std::int8_t byteSwapped(std::int8_t value) {
+    return value;
+}
+
+constexpr inline std::int16_t byteSwapped(std::int16_t value) {
+    return static_cast<std::int16_t>(byteSwapped(static_cast<std::uint16_t>(value)));
+}
+
+constexpr inline std::int32_t byteSwapped(std::int32_t value) {
+    return static_cast<std::int32_t>(byteSwapped(static_cast<std::uint32_t>(value)));
+}
+
+constexpr inline std::int64_t byteSwapped(std::int64_t value) {
+    return static_cast<std::int64_t>(byteSwapped(static_cast<std::uint64_t>(value)));
+}
+
 template<>
-void byteSwap<std::uint8_t>(std::uint8_t &subject);
+inline void byteSwap<std::uint8_t>(std::uint8_t &subject) {
+    (void) subject;
+}
 
 template<>
-void byteSwap<std::int8_t>(std::int8_t &subject);
+inline void byteSwap<std::int8_t>(std::int8_t &subject) {
+    (void) subject;
+}
 
 template<>
-void byteSwap<std::uint16_t>(std::uint16_t &subject);
+inline void byteSwap<std::uint16_t>(std::uint16_t &subject) {
+    subject = byteSwapped(subject);
+}
 
 template<>
-void byteSwap<std::int16_t>(std::int16_t &subject);
+inline void byteSwap<std::int16_t>(std::int16_t &subject) {
+    subject = byteSwapped(subject);
+}
 
 template<>
-void byteSwap<std::uint32_t>(std::uint32_t &subject);
+inline void byteSwap<std::uint32_t>(std::uint32_t &subject) {
+    subject = byteSwapped(subject);
+}
 
 template<>
-void byteSwap<std::int32_t>(std::int32_t &subject);
+inline void byteSwap<std::int32_t>(std::int32_t &subject) {
+    subject = byteSwapped(subject);
+}
 
 template <>
-void byteSwap<std::uint64_t>(std::uint64_t &subject);
+inline void byteSwap<std::uint64_t>(std::uint64_t &subject) {
+    subject = byteSwapped(subject);
+}
 
 template <>
-void byteSwap<std::int64_t>(std::int64_t &subject);
+inline void byteSwap<std::int64_t>(std::int64_t &subject) {
+    subject = byteSwapped(subject);
+}
+
+/**
+ * @brief Reverses the bytes of count values in place.
+ *
+ * Uses SSSE3 or AVX2 byte shuffles when the processor has them (see CpuDispatch), the remainder is swapped one value
+ * at a time.
+ * The data does not need any particular alignment.
+ *
+ * @param [in,out] data The values to swap.
+ * @param [in] count The number of values.
+ */
+void byteSwapArray(std::uint16_t *data, std::size_t count);
+
+void byteSwapArray(std::uint32_t *data, std::size_t count);
+
+void byteSwapArray(std::uint64_t *data, std::size_t count);
+
+inline void byteSwapArray(std::int16_t *data, std::size_t count) {
+    byteSwapArray(reinterpret_cast<std::uint16_t *>(data), count);
+}
+
+inline void byteSwapArray(std::int32_t *data, std::size_t count) {
+    byteSwapArray(reinterpret_cast<std::uint32_t *>(data), count);
+}
+
+inline void byteSwapArray(std::int64_t *data, std::size_t count) {
+    byteSwapArray(reinterpret_cast<std::uint64_t *>(data), count);
+}
 
 // Using de Bruijn Sequences to Index a 1 in a Computer Word:
 // http://supertech.csail.mit.edu/papers/debruijn.pdf
 static constexpr unsigned int deBruijn[] = {0u, 1u, 28u, 2u, 29u, 14u, 24u, 3u, 30u, 22u, 20u, 15u, 25u, 17u, 4u, 8u,
                                             31u, 27u, 13u, 23u, 21u, 19u, 16u, 7u, 26u, 12u, 18u, 6u, 11u, 5u, 10u, 9u};
 constexpr inline int bitPosition(std::uint32_t v) {
+#if defined(__GNUC__)
+    return (v != 0) ? __builtin_ctz(v) : 0;
+#else
     return deBruijn[(static_cast<std::uint32_t>((v & -v) * 0x077CB531u)) >> 27];
+#endif
+}
+
+// Portable building blocks for the bit functions below, used when the compiler has no builtins.
+namespace bits {
+
+constexpr inline std::uint32_t smear32(std::uint32_t v, int shift) {
+    return v | (v >> shift);
+}
+
+// All bits below the highest set bit are set as well.
+constexpr inline std::uint32_t fill32(std::uint32_t v) {
+    return smear32(smear32(smear32(smear32(smear32(v, 1), 2), 4), 8), 16);
+}
+
+constexpr inline int pairCount32(std::uint32_t v) {
+    return static_cast<int>((((v & 0x0f0f0f0fu) + ((v >> 4) & 0x0f0f0f0fu)) * 0x01010101u) >> 24);
+}
+
+constexpr inline int nibbleCount32(std::uint32_t v) {
+    return pairCount32((v & 0x33333333u) + ((v >> 2) & 0x33333333u));
+}
+
+constexpr inline int popCount32(std::uint32_t v) {
+    return nibbleCount32(v - ((v >> 1) & 0x55555555u));
+}
+
+constexpr inline int ctz32(std::uint32_t v) {
+#if defined(__GNUC__)
+    return (v != 0) ? __builtin_ctz(v) : 32;
+#else
+    return (v != 0) ? bitPosition(v) : 32;
+#endif
+}
+
+constexpr inline int ctz64(std::uint64_t v) {
+#if defined(__GNUC__)
+    return (v != 0) ? __builtin_ctzll(v) : 64;
+#else
+    return (static_cast<std::uint32_t>(v) != 0) ? ctz32(static_cast<std::uint32_t>(v)) :
+            (32 + ctz32(static_cast<std::uint32_t>(v >> 32)));
+#endif
+}
+
+constexpr inline int clz32(std::uint32_t v) {
+#if defined(__GNUC__)
+    return (v != 0) ? __builtin_clz(v) : 32;
+#else
+    return 32 - popCount32(fill32(v));
+#endif
+}
+
+constexpr inline int clz64(std::uint64_t v) {
+#if defined(__GNUC__)
+    return (v != 0) ? __builtin_clzll(v) : 64;
+#else
+    return ((v >> 32) != 0) ? clz32(static_cast<std::uint32_t>(v >> 32)) : (32 + clz32(static_cast<std::uint32_t>(v)));
+#endif
+}
+
+constexpr inline int popCount64(std::uint64_t v) {
+#if defined(__GNUC__)
+    return __builtin_popcountll(v);
+#else
+    return popCount32(static_cast<std::uint32_t>(v)) + popCount32(static_cast<std::uint32_t>(v >> 32));
+#endif
+}
+
+template <typename T>
+using EnableUnsigned = typename std::enable_if<std::is_unsigned<T>::value && (sizeof(T) <= 8), int>::type;
+
+} // end of ecpp::utils::bits
+
+/**
+ * @brief Returns the number of zero bits below the lowest set bit, or the width of T if value is 0.
+ *
+ * Like the other bit functions, this works on unsigned types of 8 to 64 bits and compiles to a single instruction
+ * where the target has one.
+ */
+template <typename T>
+constexpr inline bits::EnableUnsigned<T> countTrailingZeros(T value) {
+    return (value == 0) ? std::numeric_limits<T>::digits :
+            ((sizeof(T) <= 4) ? bits::ctz32(static_cast<std::uint32_t>(value)) : bits::ctz64(value));
+}
+
+/**
+ * @brief Returns the number of zero bits above the highest set bit, or the width of T if value is 0.
+ */
+template <typename T>
+constexpr inline bits::EnableUnsigned<T> countLeadingZeros(T value) {
+    return (sizeof(T) <= 4) ? (bits::clz32(static_cast<std::uint32_t>(value)) - (32 - std::numeric_limits<T>::digits)) :
+            bits::clz64(value);
+}
+
+/**
+ * @brief Returns the number of set bits.
+ */
+template <typename T>
+constexpr inline bits::EnableUnsigned<T> popCount(T value) {
+#if defined(__GNUC__)
+    return (sizeof(T) <= 4) ? __builtin_popcount(static_cast<std::uint32_t>(value)) : bits::popCount64(value);
+#else
+    return (sizeof(T) <= 4) ? bits::popCount32(static_cast<std::uint32_t>(value)) : bits::popCount64(value);
+#endif
+}
+
+/**
+ * @brief Returns the number of bits needed to represent value, 0 for 0.
+ */
+template <typename T>
+constexpr inline bits::EnableUnsigned<T> bitWidth(T value) {
+    return std::numeric_limits<T>::digits - countLeadingZeros(value);
+}
+
+/**
+ * @brief Returns the smallest power of 2 that is not less than value, 1 for 0.
+ *
+ * The result must fit in T, so value can be at most the highest power of 2 of T.
+ */
+template <typename T>
+constexpr inline typename std::enable_if<std::is_unsigned<T>::value && (sizeof(T) <= 8), T>::type nextPowerOfTwo(
+        T value) {
+    return (value <= 1) ? static_cast<T>(1) : static_cast<T>(static_cast<T>(1) << bitWidth(static_cast<T>(value - 1)));
+}
+
+/**
+ * @brief Clamps value to the range of T.
+ */
+template <typename T>
+constexpr inline T saturate(std::intmax_t value) {
+    static_assert(std::is_integral<T>::value, "Integral type required.");
+
+    return (value < static_cast<std::intmax_t>(std::numeric_limits<T>::min())) ? std::numeric_limits<T>::min() :
+            ((static_cast<std::uintmax_t>(value) > static_cast<std::uintmax_t>(std::numeric_limits<T>::max())) &&
+            (value > 0)) ? std::numeric_limits<T>::max() : static_cast<T>(value);
+}
+
+/**
+ * @brief Returns a + b, limited to the range of intmax_t instead of overflowing.
+ */
+inline std::intmax_t saturatingAdd(std::intmax_t a, std::intmax_t b) {
+    if ((b > 0) && (a > (std::numeric_limits<std::intmax_t>::max() - b))) {
+        return std::numeric_limits<std::intmax_t>::max();
+    }
+    if ((b < 0) && (a < (std::numeric_limits<std::intmax_t>::min() - b))) {
+        return std::numeric_limits<std::intmax_t>::min();
+    }
+    return a + b;
+}
+
+/**
+ * @brief Returns a - b, limited to the range of intmax_t instead of overflowing.
+ */
+inline std::intmax_t saturatingSubtract(std::intmax_t a, std::intmax_t b) {
+    if ((b < 0) && (a > (std::numeric_limits<std::intmax_t>::max() + b))) {
+        return std::numeric_limits<std::intmax_t>::max();
+    }
+    if ((b > 0) && (a < (std::numeric_limits<std::intmax_t>::min() + b))) {
+        return std::numeric_limits<std::intmax_t>::min();
+    }
+    return a - b;
+}
+
+/**
+ * @brief Returns value * num / den rounded towards 0, limited to the range of intmax_t instead of overflowing.
+ *
+ * The product is formed at double width, so the result is exact whenever it fits. A den of 0 gives 0.
+ */
+inline std::intmax_t saturatingMulDiv(std::intmax_t value, std::intmax_t num, std::intmax_t den) {
+    if (den == 0) {
+        return 0;
+    }
+
+#if defined(__SIZEOF_INT128__) && (INTMAX_MAX <= INT64_MAX)
+    __extension__ typedef __int128 Wide;
+
+    Wide result = (static_cast<Wide>(value) * num) / den;
+    if (result > std::numeric_limits<std::intmax_t>::max()) {
+        return std::numeric_limits<std::intmax_t>::max();
+    }
+    if (result < std::numeric_limits<std::intmax_t>::min()) {
+        return std::numeric_limits<std::intmax_t>::min();
+    }
+    return static_cast<std::intmax_t>(result);
+#else
+    static_assert(sizeof(std::uintmax_t) == 8, "Only a 64 bit intmax_t is supported without __int128.");
+
+    bool negative = ((value < 0) != (num < 0)) != (den < 0);
+    std::uint64_t v = (value < 0) ? (0 - static_cast<std::uint64_t>(value)) : static_cast<std::uint64_t>(value);
+    std::uint64_t n = (num < 0) ? (0 - static_cast<std::uint64_t>(num)) : static_cast<std::uint64_t>(num);
+    std::uint64_t d = (den < 0) ? (0 - static_cast<std::uint64_t>(den)) : static_cast<std::uint64_t>(den);
+    std::uint64_t limit = static_cast<std::uint64_t>(std::numeric_limits<std::intmax_t>::max()) + (negative ? 1 : 0);
+    std::uint64_t quotient;
+
+    if (((v >> 32) == 0) && ((n >> 32) == 0)) {
+        // The common case, the product fits in 64 bits.
+        quotient = (v * n) / d;
+    } else {
+        // Full 128 bit product from 32 bit halves.
+        std::uint64_t p0 = (v & 0xffffffffu) * (n & 0xffffffffu);
+        std::uint64_t p1 = (v & 0xffffffffu) * (n >> 32);
+        std::uint64_t p2 = (v >> 32) * (n & 0xffffffffu);
+        std::uint64_t p3 = (v >> 32) * (n >> 32);
+        std::uint64_t middle = (p0 >> 32) + (p1 & 0xffffffffu) + (p2 & 0xffffffffu);
+        std::uint64_t low = (p0 & 0xffffffffu) | (middle << 32);
+        std::uint64_t high = p3 + (p1 >> 32) + (p2 >> 32) + (middle >> 32);
+
+        if (high >= d) {
+            // The quotient does not even fit in 64 bits.
+            quotient = ~static_cast<std::uint64_t>(0);
+        } else {
+            // Restoring division of the 128 bit product, one quotient bit per step.
+            quotient = 0;
+            for (int i = 0; i < 64; ++i) {
+                bool carry = (high >> 63) != 0;
+                high = (high << 1) | (low >> 63);
+                low <<= 1;
+                quotient <<= 1;
+                if ((carry == true) || (high >= d)) {
+                    high -= d;
+                    quotient |= 1;
+                }
+            }
+        }
+    }
+
+    if (quotient > limit) {
+        return negative ? std::numeric_limits<std::intmax_t>::min() : std::numeric_limits<std::intmax_t>::max();
+    }
+
+    return negative ? static_cast<std::intmax_t>(0 - quotient) : static_cast<std::intmax_t>(quotient);
+#endif
+}
+
+/**
+ * @brief Range over the positions of the set bits of a value, lowest first: for (int bit : setBits(mask)) ...
+ */
+template <typename T>
+class SetBits {
+public:
+    class Iterator {
+    public:
+        constexpr Iterator(T value) : _value(value) {
+        }
+
+        int operator *() const {
+            return countTrailingZeros(_value);
+        }
+
+        Iterator &operator ++() {
+            // Clears the lowest set bit.
+            _value = static_cast<T>(_value & (_value - 1));
+            return *this;
+        }
+
+        bool operator !=(const Iterator &other) const {
+            return _value != other._value;
+        }
+
+    private:
+        T _value;
+    };
+
+    constexpr SetBits(T value) : _value(value) {
+    }
+
+    Iterator begin() const {
+        return Iterator(_value);
+    }
+
+    Iterator end() const {
+        return Iterator(0);
+    }
+
+private:
+    T _value;
+};
+
+template <typename T>
+constexpr inline SetBits<T> setBits(T value) {
+    return SetBits<T>(value);
 }
 } // end of ecpp::utils
 
@@ -15,8 +15,15 @@
 sources += \
 	ecpp/src/allocator.cpp \
 	ecpp/src/assertsafe.cpp \
+	ecpp/src/cpufeatures.cpp \
+	ecpp/src/loopscheduler.cpp \
+	ecpp/src/mappedfile.cpp \
+	ecpp/src/pidbank.cpp \
 	ecpp/src/poolallocator.cpp \
+	ecpp/src/range.cpp \
+	ecpp/src/taskpool.cpp \
 	ecpp/src/throwsafe.cpp \
+	ecpp/src/traceallocator.cpp \
 	ecpp/src/utils.cpp \
 
 includes += ecpp/inc
@@ -31,3 +31,11 @@ void *ecpp::Allocator::allocate(std::size_t size) {
 void ecpp::Allocator::deallocate(void *address) {
     ::operator delete(address);
 }
+
+bool ecpp::Allocator::resize(void *address, std::size_t size) {
+    (void) address;
+    (void) size;
+
+    // The global heap has no way to resize in place.
+    return false;
+}
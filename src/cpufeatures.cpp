@@ -0,0 +1,112 @@
+/*
+ * Copyright 2015 Erik Van Hamme
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "cpufeatures.h"
+
+#if defined(__linux__) && (defined(__aarch64__) || defined(__arm__))
+#include <sys/auxv.h>
+#endif
+
+// Generation 0 is never used, so a new CpuDispatch always resolves on its first call.
+std::atomic<unsigned int> ecpp::CpuFeatures::_generation(1);
+std::atomic<int> ecpp::CpuFeatures::_forcedLevel(-1);
+
+namespace {
+
+ecpp::CpuFeature detectFeatures() {
+    ecpp::CpuFeature features = ecpp::CpuFeature::NONE;
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+    // These also check that the operating system saves the wide registers.
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("sse2")) {
+        features = features | ecpp::CpuFeature::SSE2;
+    }
+    if (__builtin_cpu_supports("ssse3")) {
+        features = features | ecpp::CpuFeature::SSSE3;
+    }
+    if (__builtin_cpu_supports("avx2")) {
+        features = features | ecpp::CpuFeature::AVX2;
+    }
+    if (__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw")) {
+        features = features | ecpp::CpuFeature::AVX512;
+    }
+#elif defined(__aarch64__)
+    // Advanced SIMD is part of the base ARMv8-A architecture.
+    features = features | ecpp::CpuFeature::NEON;
+#elif defined(__linux__) && defined(__arm__)
+    if ((getauxval(AT_HWCAP) & HWCAP_NEON) != 0) {
+        features = features | ecpp::CpuFeature::NEON;
+    }
+#endif
+
+    return features;
+}
+
+ecpp::CpuLevel levelOf(ecpp::CpuFeature features) {
+    // Every level also needs all the levels below it.
+    ecpp::CpuLevel level = ecpp::CpuLevel::SCALAR;
+    if ((features & ecpp::CpuFeature::SSE2) != ecpp::CpuFeature::NONE) {
+        level = ecpp::CpuLevel::SSE2;
+        if ((features & ecpp::CpuFeature::SSSE3) != ecpp::CpuFeature::NONE) {
+            level = ecpp::CpuLevel::SSSE3;
+            if ((features & ecpp::CpuFeature::AVX2) != ecpp::CpuFeature::NONE) {
+                level = ecpp::CpuLevel::AVX2;
+                if ((features & ecpp::CpuFeature::AVX512) != ecpp::CpuFeature::NONE) {
+                    level = ecpp::CpuLevel::AVX512;
+                }
+            }
+        }
+    }
+    return level;
+}
+
+} // anonymous
+
+ecpp::CpuFeature ecpp::CpuFeatures::features() {
+    static const CpuFeature detected = detectFeatures();
+    return detected;
+}
+
+bool ecpp::CpuFeatures::has(CpuFeature feature) {
+    return (features() & feature) == feature;
+}
+
+ecpp::CpuLevel ecpp::CpuFeatures::detectedLevel() {
+    static const CpuLevel detected = levelOf(features());
+    return detected;
+}
+
+ecpp::CpuLevel ecpp::CpuFeatures::level() {
+    int forced = _forcedLevel.load(std::memory_order_relaxed);
+    CpuLevel detected = detectedLevel();
+
+    if ((forced >= 0) && (forced < static_cast<int>(detected))) {
+        return static_cast<CpuLevel>(forced);
+    }
+
+    return detected;
+}
+
+void ecpp::CpuFeatures::forceLevel(CpuLevel level) {
+    _forcedLevel.store(static_cast<int>(level), std::memory_order_relaxed);
+    _generation.fetch_add(1, std::memory_order_acq_rel);
+}
+
+void ecpp::CpuFeatures::resetLevel() {
+    _forcedLevel.store(-1, std::memory_order_relaxed);
+    _generation.fetch_add(1, std::memory_order_acq_rel);
+}
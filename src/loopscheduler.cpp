@@ -0,0 +1,344 @@
+/*
+ * Copyright 2015 Erik Van Hamme
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "loopscheduler.h"
+
+#include "priorityqueue.h"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <new>
+#include <thread>
+
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#define ECPP_HAVE_AFFINITY
+#endif
+
+namespace {
+
+struct Release {
+    ecpp::LoopScheduler::Clock::time_point time;
+    std::size_t task;
+};
+
+class ReleaseComparator {
+public:
+    // The earliest release comes first.
+    int compare(const Release &a, const Release &b) const {
+        if (a.time < b.time) {
+            return 1;
+        } else if (b.time < a.time) {
+            return -1;
+        } else {
+            return 0;
+        }
+    }
+};
+
+typedef ecpp::PriorityQueue<Release, ReleaseComparator> ReleaseQueue;
+
+// Only the worker of a task writes its statistics, so a relaxed load and store is enough to keep a maximum.
+void storeMax(std::atomic<std::int64_t> &maximum, std::int64_t value) {
+    if (value > maximum.load(std::memory_order_relaxed)) {
+        maximum.store(value, std::memory_order_relaxed);
+    }
+}
+
+void pin(std::thread &thread, std::size_t cpu) {
+#ifdef ECPP_HAVE_AFFINITY
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    pthread_setaffinity_np(thread.native_handle(), sizeof(set), &set);
+#else
+    (void) thread;
+    (void) cpu;
+#endif
+}
+
+} // anonymous
+
+struct ecpp::LoopScheduler::Task {
+    Function function;
+    void *context;
+    Clock::duration period;
+    Clock::duration deadline;
+    std::size_t worker;
+
+    // Durations in nanoseconds.
+    std::atomic<std::uint64_t> runs;
+    std::atomic<std::uint64_t> overruns;
+    std::atomic<std::uint64_t> skippedReleases;
+    std::atomic<std::int64_t> maxJitter;
+    std::atomic<std::int64_t> totalJitter;
+    std::atomic<std::int64_t> maxExecution;
+    std::atomic<std::int64_t> maxResponse;
+};
+
+struct ecpp::LoopScheduler::Worker {
+    std::thread thread;
+    std::mutex mutex;
+    std::condition_variable wakeup;
+    bool stopping;
+    ReleaseQueue *queue;
+    std::size_t taskCount;
+
+    // Sum of cost / period of the tasks, in parts per million.
+    std::uint64_t utilisation;
+};
+
+ecpp::LoopScheduler::LoopScheduler(Allocator &allocator, std::size_t capacity, std::size_t workerCount, bool pin) :
+        _allocator(allocator), _tasks(nullptr), _workers(nullptr), _capacity(0), _size(0), _workerCount(0),
+        _pin(pin), _running(false) {
+
+    if (workerCount == 0) {
+        workerCount = std::thread::hardware_concurrency();
+        if (workerCount == 0) {
+            workerCount = 1;
+        }
+    }
+
+    if (capacity == 0) {
+        return;
+    }
+
+    void *mem = _allocator.allocate((sizeof(Task) * capacity) + (sizeof(Worker) * workerCount));
+    if (mem == nullptr) {
+        return;
+    }
+
+    // The workers come first in the block, they have the strictest alignment.
+    _workers = static_cast<Worker *>(mem);
+    _tasks = reinterpret_cast<Task *>(_workers + workerCount);
+    _capacity = capacity;
+    _workerCount = workerCount;
+
+    for (std::size_t i = 0; i < _workerCount; ++i) {
+        Worker *worker = new (&_workers[i]) Worker();
+        worker->stopping = false;
+        worker->queue = nullptr;
+        worker->taskCount = 0;
+        worker->utilisation = 0;
+    }
+}
+
+ecpp::LoopScheduler::~LoopScheduler() {
+    stop();
+
+    if (_workers == nullptr) {
+        return;
+    }
+
+    for (std::size_t i = 0; i < _size; ++i) {
+        _tasks[i].~Task();
+    }
+    for (std::size_t i = 0; i < _workerCount; ++i) {
+        _workers[i].~Worker();
+    }
+    _allocator.deallocate(_workers);
+}
+
+ecpp::LoopScheduler::TaskId ecpp::LoopScheduler::add(Function function, void *context, const TaskConfig &config) {
+    if ((_running == true) || (_size == _capacity) || (config.period <= Clock::duration::zero())) {
+        return INVALID_TASK;
+    }
+
+    std::size_t worker = config.worker;
+    if (worker == ANY_WORKER) {
+        // Least utilised worker first, the one with the fewest tasks when the costs are unknown.
+        worker = 0;
+        for (std::size_t i = 1; i < _workerCount; ++i) {
+            if ((_workers[i].utilisation < _workers[worker].utilisation) || ((_workers[i].utilisation ==
+                    _workers[worker].utilisation) && (_workers[i].taskCount < _workers[worker].taskCount))) {
+                worker = i;
+            }
+        }
+    } else if (worker >= _workerCount) {
+        return INVALID_TASK;
+    }
+
+    TaskId id = _size;
+    Task *task = new (&_tasks[id]) Task();
+    task->function = function;
+    task->context = context;
+    task->period = config.period;
+    task->deadline = (config.deadline > Clock::duration::zero()) ? config.deadline : config.period;
+    task->worker = worker;
+    ++_size;
+
+    resetStatistics(id);
+
+    _workers[worker].taskCount++;
+    _workers[worker].utilisation += static_cast<std::uint64_t>((config.cost * 1000000) / config.period);
+
+    return id;
+}
+
+std::size_t ecpp::LoopScheduler::workerOf(TaskId task) const {
+    return _tasks[task].worker;
+}
+
+bool ecpp::LoopScheduler::start() {
+    if ((_running == true) || (_workers == nullptr)) {
+        return false;
+    }
+
+    // Release queues, all allocated before any worker runs.
+    for (std::size_t i = 0; i < _workerCount; ++i) {
+        Worker &worker = _workers[i];
+        if (worker.taskCount == 0) {
+            continue;
+        }
+
+        void *mem = _allocator.allocate(sizeof(ReleaseQueue));
+        if (mem != nullptr) {
+            worker.queue = new (mem) ReleaseQueue(_allocator, worker.taskCount, ReleaseComparator());
+        }
+        if ((worker.queue == nullptr) || (worker.queue->capacity() < worker.taskCount)) {
+            stop();
+            return false;
+        }
+    }
+
+    Clock::time_point now = Clock::now();
+    for (std::size_t i = 0; i < _size; ++i) {
+        Release release = {now, i};
+        _workers[_tasks[i].worker].queue->push(release);
+    }
+
+    std::size_t cpus = std::thread::hardware_concurrency();
+    for (std::size_t i = 0; i < _workerCount; ++i) {
+        Worker &worker = _workers[i];
+        if (worker.queue == nullptr) {
+            continue;
+        }
+
+        worker.stopping = false;
+        worker.thread = std::thread(&LoopScheduler::run, this, std::ref(worker));
+        if ((_pin == true) && (cpus != 0)) {
+            pin(worker.thread, i % cpus);
+        }
+    }
+
+    _running = true;
+
+    return true;
+}
+
+void ecpp::LoopScheduler::stop() {
+    if (_workers == nullptr) {
+        return;
+    }
+
+    for (std::size_t i = 0; i < _workerCount; ++i) {
+        Worker &worker = _workers[i];
+        if (worker.thread.joinable() == true) {
+            {
+                std::lock_guard<std::mutex> lock(worker.mutex);
+                worker.stopping = true;
+            }
+            worker.wakeup.notify_one();
+            worker.thread.join();
+        }
+
+        if (worker.queue != nullptr) {
+            worker.queue->~ReleaseQueue();
+            _allocator.deallocate(worker.queue);
+            worker.queue = nullptr;
+        }
+    }
+
+    _running = false;
+}
+
+ecpp::LoopStatistics ecpp::LoopScheduler::statistics(TaskId task) const {
+    const Task &t = _tasks[task];
+
+    LoopStatistics result;
+    result.runs = t.runs.load(std::memory_order_relaxed);
+    result.overruns = t.overruns.load(std::memory_order_relaxed);
+    result.skippedReleases = t.skippedReleases.load(std::memory_order_relaxed);
+    result.maxJitter = std::chrono::nanoseconds(t.maxJitter.load(std::memory_order_relaxed));
+    result.meanJitter = std::chrono::nanoseconds((result.runs != 0) ?
+            (t.totalJitter.load(std::memory_order_relaxed) / static_cast<std::int64_t>(result.runs)) : 0);
+    result.maxExecution = std::chrono::nanoseconds(t.maxExecution.load(std::memory_order_relaxed));
+    result.maxResponse = std::chrono::nanoseconds(t.maxResponse.load(std::memory_order_relaxed));
+
+    return result;
+}
+
+void ecpp::LoopScheduler::resetStatistics(TaskId task) {
+    Task &t = _tasks[task];
+
+    // A run that ends during the reset can leave part of its numbers behind.
+    t.runs.store(0, std::memory_order_relaxed);
+    t.overruns.store(0, std::memory_order_relaxed);
+    t.skippedReleases.store(0, std::memory_order_relaxed);
+    t.maxJitter.store(0, std::memory_order_relaxed);
+    t.totalJitter.store(0, std::memory_order_relaxed);
+    t.maxExecution.store(0, std::memory_order_relaxed);
+    t.maxResponse.store(0, std::memory_order_relaxed);
+}
+
+void ecpp::LoopScheduler::run(Worker &worker) {
+    ReleaseQueue &queue = *worker.queue;
+
+    std::unique_lock<std::mutex> lock(worker.mutex);
+    while (true) {
+        Release release = queue.top();
+        if (worker.wakeup.wait_until(lock, release.time, [&worker] { return worker.stopping; }) == true) {
+            break;
+        }
+        lock.unlock();
+
+        Task &task = _tasks[release.task];
+
+        Clock::time_point start = Clock::now();
+        task.function(task.context);
+        Clock::time_point end = Clock::now();
+
+        std::int64_t jitter = std::chrono::duration_cast<std::chrono::nanoseconds>(start - release.time).count();
+        std::int64_t execution = std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+        std::int64_t response = std::chrono::duration_cast<std::chrono::nanoseconds>(end - release.time).count();
+
+        task.runs.store(task.runs.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        task.totalJitter.store(task.totalJitter.load(std::memory_order_relaxed) + jitter, std::memory_order_relaxed);
+        storeMax(task.maxJitter, jitter);
+        storeMax(task.maxExecution, execution);
+        storeMax(task.maxResponse, response);
+        if ((end - release.time) > task.deadline) {
+            task.overruns.store(task.overruns.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        }
+
+        // The next release keeps the phase of the task, releases that already passed are skipped.
+        Clock::duration::rep missed = (end - release.time) / task.period;
+        if (missed > 0) {
+            task.skippedReleases.store(task.skippedReleases.load(std::memory_order_relaxed) +
+                    static_cast<std::uint64_t>(missed), std::memory_order_relaxed);
+        }
+        release.time += task.period * (missed + 1);
+
+        lock.lock();
+        queue.update(queue.topHandle(), release);
+    }
+}
@@ -0,0 +1,84 @@
+/*
+ * Copyright 2015 Erik Van Hamme
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "mappedfile.h"
+
+#include <cstddef>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define ECPP_HAVE_MMAP
+#endif
+
+ecpp::MappedFile::MappedFile() : _data(nullptr), _size(0) {
+}
+
+ecpp::MappedFile::~MappedFile() {
+    close();
+}
+
+bool ecpp::MappedFile::open(const char *path, bool writable) {
+    close();
+
+#ifdef ECPP_HAVE_MMAP
+    int fd = ::open(path, writable ? O_RDWR : O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+
+    struct stat info;
+    if ((fstat(fd, &info) != 0) || (info.st_size <= 0)) {
+        // Empty files cannot be mapped.
+        ::close(fd);
+        return false;
+    }
+
+    std::size_t size = static_cast<std::size_t>(info.st_size);
+    int protection = writable ? (PROT_READ | PROT_WRITE) : PROT_READ;
+    void *data = mmap(nullptr, size, protection, writable ? MAP_SHARED : MAP_PRIVATE, fd, 0);
+
+    // The mapping stays valid after the descriptor is closed.
+    ::close(fd);
+
+    if (data == MAP_FAILED) {
+        return false;
+    }
+
+    _data = data;
+    _size = size;
+
+    return true;
+#else
+    (void) path;
+    (void) writable;
+
+    return false;
+#endif
+}
+
+void ecpp::MappedFile::close() {
+#ifdef ECPP_HAVE_MMAP
+    if (_data != nullptr) {
+        munmap(_data, _size);
+    }
+#endif
+
+    _data = nullptr;
+    _size = 0;
+}
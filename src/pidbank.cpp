@@ -0,0 +1,185 @@
+/*
+ * Copyright 2015 Erik Van Hamme
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "pidbank.h"
+
+#include "cpufeatures.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+namespace {
+
+// Same as Range::apply with the bounds from PidBank::setBounds, but without branches.
+template <typename T>
+inline T clamp(T value, T from, T to) {
+    T limited = (to < value) ? to : value;
+    return (value < from) ? from : limited;
+}
+
+// One Pid::update step for loops first up to count, in the order of operations of Pid::update.
+template <typename T>
+void updateScalar(const ecpp::PidBankArrays<T> &a, const T *signals, std::size_t first, std::size_t count) {
+    for (std::size_t k = first; k < count; ++k) {
+        T error = a.setPoint[k] - signals[k];
+
+        T pOut = clamp(error * a.p[k], a.pFrom[k], a.pTo[k]);
+
+        a.accumulatedError[k] = clamp(a.accumulatedError[k] + error, a.iFrom[k], a.iTo[k]);
+        T iOut = a.accumulatedError[k] * a.i[k];
+
+        T diff = error - a.previousError[k];
+        T dOut = clamp(diff * a.d[k], a.dFrom[k], a.dTo[k]);
+        a.previousError[k] = error;
+
+        a.output[k] = clamp(pOut + iOut + dOut, a.outFrom[k], a.outTo[k]);
+    }
+}
+
+template <typename T>
+void updateAll(const ecpp::PidBankArrays<T> &a, const T *signals, std::size_t count) {
+    updateScalar(a, signals, 0, count);
+}
+
+#ifdef ECPP_X86_DISPATCH
+
+/*
+ * The vector kernels use the generic vector types of the compiler instead of intrinsics. The kernel below is always
+ * inlined into a function with a target attribute, which decides the instructions the vector operations map to.
+ */
+template <typename T, std::size_t BYTES>
+struct Vectors {
+    typedef T Vector __attribute__((vector_size(BYTES)));
+    typedef typename std::conditional<sizeof(T) == 4, std::int32_t, std::int64_t>::type MaskElement;
+    typedef MaskElement Mask __attribute__((vector_size(BYTES)));
+
+    static constexpr std::size_t WIDTH = BYTES / sizeof(T);
+};
+
+// The helpers take vectors by reference, vectors passed by value would depend on the calling convention of the target.
+template <typename Tvector>
+__attribute__((always_inline)) inline void loadVector(Tvector &v, const void *source) {
+    std::memcpy(&v, source, sizeof(v));
+}
+
+template <typename Tvector>
+__attribute__((always_inline)) inline void storeVector(void *destination, const Tvector &v) {
+    std::memcpy(destination, &v, sizeof(v));
+}
+
+// Clamps value in place between the bounds loaded from from and to.
+template <typename T, std::size_t BYTES>
+__attribute__((always_inline)) inline void clampVector(typename Vectors<T, BYTES>::Vector &value, const T *from,
+        const T *to) {
+    typedef typename Vectors<T, BYTES>::Vector Vector;
+    typedef typename Vectors<T, BYTES>::Mask Mask;
+
+    Vector lower;
+    Vector upper;
+    loadVector(lower, from);
+    loadVector(upper, to);
+
+    Mask above = (Mask) (upper < value);
+    Mask limited = (above & (Mask) upper) | (~above & (Mask) value);
+    Mask below = (Mask) (value < lower);
+    value = (Vector) ((below & (Mask) lower) | (~below & limited));
+}
+
+// Updates whole vectors of loops, returns the number of loops that were done.
+template <typename T, std::size_t BYTES>
+__attribute__((always_inline)) inline std::size_t updateVectors(const ecpp::PidBankArrays<T> &a, const T *signals,
+        std::size_t count) {
+    typedef typename Vectors<T, BYTES>::Vector Vector;
+    const std::size_t width = Vectors<T, BYTES>::WIDTH;
+
+    std::size_t k = 0;
+    for (; (k + width) <= count; k += width) {
+        Vector setPoint;
+        Vector signal;
+        Vector p;
+        Vector i;
+        Vector d;
+        Vector accumulated;
+        Vector previous;
+        loadVector(setPoint, a.setPoint + k);
+        loadVector(signal, signals + k);
+        loadVector(p, a.p + k);
+        loadVector(i, a.i + k);
+        loadVector(d, a.d + k);
+        loadVector(accumulated, a.accumulatedError + k);
+        loadVector(previous, a.previousError + k);
+
+        Vector error = setPoint - signal;
+
+        Vector pOut = error * p;
+        clampVector<T, BYTES>(pOut, a.pFrom + k, a.pTo + k);
+
+        accumulated = accumulated + error;
+        clampVector<T, BYTES>(accumulated, a.iFrom + k, a.iTo + k);
+        storeVector(a.accumulatedError + k, accumulated);
+        Vector iOut = accumulated * i;
+
+        Vector diff = error - previous;
+        Vector dOut = diff * d;
+        clampVector<T, BYTES>(dOut, a.dFrom + k, a.dTo + k);
+        storeVector(a.previousError + k, error);
+
+        Vector out = pOut + iOut + dOut;
+        clampVector<T, BYTES>(out, a.outFrom + k, a.outTo + k);
+        storeVector(a.output + k, out);
+    }
+
+    return k;
+}
+
+template <typename T>
+__attribute__((target("sse2"))) void updateSse2(const ecpp::PidBankArrays<T> &a, const T *signals,
+        std::size_t count) {
+    updateScalar(a, signals, updateVectors<T, 16>(a, signals, count), count);
+}
+
+// AVX2 is not needed for these operations, but it is the level that comes with AVX on every supported processor.
+template <typename T>
+__attribute__((target("avx2"))) void updateAvx2(const ecpp::PidBankArrays<T> &a, const T *signals,
+        std::size_t count) {
+    updateScalar(a, signals, updateVectors<T, 32>(a, signals, count), count);
+}
+
+#endif
+
+template <typename T>
+void updateDispatched(const ecpp::PidBankArrays<T> &a, const T *signals, std::size_t count) {
+    // No AVX-512 kernel: its targets enable FMA, which could fuse the multiply and add that Pid rounds separately.
+#ifdef ECPP_X86_DISPATCH
+    static ecpp::CpuDispatch<void(const ecpp::PidBankArrays<T> &, const T *, std::size_t)> dispatch(updateAll<T>,
+            updateSse2<T>, nullptr, updateAvx2<T>);
+#else
+    static ecpp::CpuDispatch<void(const ecpp::PidBankArrays<T> &, const T *, std::size_t)> dispatch(updateAll<T>);
+#endif
+
+    dispatch.get()(a, signals, count);
+}
+
+} // anonymous
+
+void ecpp::pidBankUpdate(const PidBankArrays<float> &arrays, const float *signals, std::size_t count) {
+    updateDispatched(arrays, signals, count);
+}
+
+void ecpp::pidBankUpdate(const PidBankArrays<double> &arrays, const double *signals, std::size_t count) {
+    updateDispatched(arrays, signals, count);
+}
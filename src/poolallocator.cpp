@@ -52,6 +52,11 @@ void *ecpp::PoolAllocator::allocate(std::size_t size) {
         blocksNeeded++;
     }
 
+    // The meta information of a block can only count up to 255 blocks, and 0 marks a free block.
+    if ((blocksNeeded == 0) || (blocksNeeded > 255u)) {
+        return nullptr;
+    }
+
     int firstFreeBlock = findFreeBlocks(blocksNeeded);
 
     if (firstFreeBlock == -1) {
@@ -78,10 +83,52 @@ void ecpp::PoolAllocator::deallocate(void *address) {
     }
 }
 
+bool ecpp::PoolAllocator::resize(void *address, std::size_t size) {
+
+    auto min = reinterpret_cast<std::size_t>(_dataMem);
+    auto max = min + _dataMemSize - _blockSize;
+
+    auto addressNumerical = reinterpret_cast<std::size_t>(address);
+
+    if ((addressNumerical < min) || (max < addressNumerical) || (size == 0)) {
+        return false;
+    }
+
+    auto block = (addressNumerical - min) / _blockSize;
+    std::size_t blocksUsed = _metaMem[block];
+
+    auto blocksNeeded = size / _blockSize;
+    if (size % _blockSize) {
+        blocksNeeded++;
+    }
+
+    // The meta information of a block can only count up to 255 blocks.
+    if ((blocksUsed == 0) || (blocksNeeded > 255u) || (blocksNeeded > (_blockCount - block))) {
+        return false;
+    }
+
+    // Growing is only possible if the blocks right after the allocation are free. Blocks after the end of an
+    // allocation that have no meta information are not part of any other allocation.
+    for (std::size_t i = blocksUsed; i < blocksNeeded; ++i) {
+        if (_metaMem[block + i] != 0) {
+            return false;
+        }
+    }
+
+    _metaMem[block] = blocksNeeded;
+
+    return true;
+}
+
 int ecpp::PoolAllocator::findFreeBlocks(std::size_t blocksNeeded) const {
 
     // Here, the first available slot of at least size bytes is located using the first-fit approach.
 
+    // Requests larger than the whole pool would make the limit below wrap around.
+    if (blocksNeeded > _metaMemSize) {
+        return -1;
+    }
+
     std::size_t pos = 0;
     std::size_t limit = _metaMemSize - blocksNeeded;
 
@@ -100,7 +147,9 @@ int ecpp::PoolAllocator::findFreeBlocks(std::size_t blocksNeeded) const {
 
                 if (_metaMem[pos + i] != 0) {
                     free = false;
-                    pos = pos + i + 1;
+
+                    // Continue at the used block, so the next iteration skips over all of its blocks.
+                    pos = pos + i;
                     break;
                 }
             }
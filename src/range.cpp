@@ -0,0 +1,260 @@
+/*
+ * Copyright 2015 Erik Van Hamme
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "range.h"
+
+#include "cpufeatures.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+namespace {
+
+template <typename T>
+void clampScalar(T *values, std::size_t count, T from, T to) {
+    ecpp::rangeClampArray<T>(values, count, from, to);
+}
+
+template <typename T>
+bool containsScalar(const T *values, std::size_t count, T from, T to) {
+    return ecpp::rangeContainsArray<T>(values, count, from, to);
+}
+
+#ifdef ECPP_X86_DISPATCH
+
+// Generic vector types, as in pidbank.cpp. The target attribute of the calling kernel decides the instructions.
+template <typename T, std::size_t BYTES>
+struct Vectors {
+    typedef T Vector __attribute__((vector_size(BYTES)));
+    typedef typename std::conditional<sizeof(T) == 1, std::int8_t,
+            typename std::conditional<sizeof(T) == 2, std::int16_t,
+            typename std::conditional<sizeof(T) == 4, std::int32_t, std::int64_t>::type>::type>::type MaskElement;
+    typedef MaskElement Mask __attribute__((vector_size(BYTES)));
+
+    static constexpr std::size_t WIDTH = BYTES / sizeof(T);
+};
+
+// Clamps whole vectors of values, returns the number of values that were done.
+template <typename T, std::size_t BYTES>
+__attribute__((always_inline)) inline std::size_t clampVectors(T *values, std::size_t count, T from, T to) {
+    typedef typename Vectors<T, BYTES>::Vector Vector;
+    typedef typename Vectors<T, BYTES>::Mask Mask;
+    const std::size_t width = Vectors<T, BYTES>::WIDTH;
+
+    Vector lower;
+    Vector upper;
+    for (std::size_t k = 0; k < width; ++k) {
+        lower[k] = from;
+        upper[k] = to;
+    }
+
+    std::size_t done = 0;
+    for (; (done + width) <= count; done += width) {
+        Vector value;
+        std::memcpy(&value, values + done, sizeof(value));
+
+        // The same selects as Range::apply, the compiler turns them into min and max where the target has them.
+        Mask above = (Mask) (upper < value);
+        Mask limited = (above & (Mask) upper) | (~above & (Mask) value);
+        Mask below = (Mask) (value < lower);
+        value = (Vector) ((below & (Mask) lower) | (~below & limited));
+
+        std::memcpy(values + done, &value, sizeof(value));
+    }
+
+    return done;
+}
+
+// Checks whole vectors of values, returns the number of values that were checked.
+template <typename T, std::size_t BYTES>
+__attribute__((always_inline)) inline std::size_t containsVectors(const T *values, std::size_t count, T from, T to,
+        bool &contained) {
+    typedef typename Vectors<T, BYTES>::Vector Vector;
+    typedef typename Vectors<T, BYTES>::Mask Mask;
+    const std::size_t width = Vectors<T, BYTES>::WIDTH;
+
+    Vector lower;
+    Vector upper;
+    Mask inside;
+    for (std::size_t k = 0; k < width; ++k) {
+        lower[k] = from;
+        upper[k] = to;
+        inside[k] = -1;
+    }
+
+    // Lanes only lose their bits, a single test at the end gives the answer without a branch per vector.
+    std::size_t done = 0;
+    for (; (done + width) <= count; done += width) {
+        Vector value;
+        std::memcpy(&value, values + done, sizeof(value));
+        inside &= (Mask) ((lower <= value) & (value <= upper));
+    }
+
+    contained = true;
+    for (std::size_t k = 0; k < width; ++k) {
+        contained = contained & (inside[k] != 0);
+    }
+    return done;
+}
+
+template <typename T>
+__attribute__((target("sse2"))) void clampSse2(T *values, std::size_t count, T from, T to) {
+    std::size_t done = clampVectors<T, 16>(values, count, from, to);
+    clampScalar(values + done, count - done, from, to);
+}
+
+template <typename T>
+__attribute__((target("avx2"))) void clampAvx2(T *values, std::size_t count, T from, T to) {
+    std::size_t done = clampVectors<T, 32>(values, count, from, to);
+    clampScalar(values + done, count - done, from, to);
+}
+
+template <typename T>
+__attribute__((target("avx512f,avx512bw"))) void clampAvx512(T *values, std::size_t count, T from, T to) {
+    std::size_t done = clampVectors<T, 64>(values, count, from, to);
+    clampScalar(values + done, count - done, from, to);
+}
+
+template <typename T>
+__attribute__((target("sse2"))) bool containsSse2(const T *values, std::size_t count, T from, T to) {
+    bool contained;
+    std::size_t done = containsVectors<T, 16>(values, count, from, to, contained);
+    return contained && containsScalar(values + done, count - done, from, to);
+}
+
+template <typename T>
+__attribute__((target("avx2"))) bool containsAvx2(const T *values, std::size_t count, T from, T to) {
+    bool contained;
+    std::size_t done = containsVectors<T, 32>(values, count, from, to, contained);
+    return contained && containsScalar(values + done, count - done, from, to);
+}
+
+template <typename T>
+__attribute__((target("avx512f,avx512bw"))) bool containsAvx512(const T *values, std::size_t count, T from, T to) {
+    bool contained;
+    std::size_t done = containsVectors<T, 64>(values, count, from, to, contained);
+    return contained && containsScalar(values + done, count - done, from, to);
+}
+
+#endif
+
+template <typename T>
+void clampDispatched(T *values, std::size_t count, T from, T to) {
+#ifdef ECPP_X86_DISPATCH
+    static ecpp::CpuDispatch<void(T *, std::size_t, T, T)> dispatch(clampScalar<T>, clampSse2<T>, nullptr,
+            clampAvx2<T>, clampAvx512<T>);
+#else
+    static ecpp::CpuDispatch<void(T *, std::size_t, T, T)> dispatch(clampScalar<T>);
+#endif
+
+    dispatch.get()(values, count, from, to);
+}
+
+template <typename T>
+bool containsDispatched(const T *values, std::size_t count, T from, T to) {
+#ifdef ECPP_X86_DISPATCH
+    static ecpp::CpuDispatch<bool(const T *, std::size_t, T, T)> dispatch(containsScalar<T>, containsSse2<T>,
+            nullptr, containsAvx2<T>, containsAvx512<T>);
+#else
+    static ecpp::CpuDispatch<bool(const T *, std::size_t, T, T)> dispatch(containsScalar<T>);
+#endif
+
+    return dispatch.get()(values, count, from, to);
+}
+
+} // anonymous
+
+void ecpp::rangeClampArray(std::int8_t *values, std::size_t count, std::int8_t from, std::int8_t to) {
+    clampDispatched(values, count, from, to);
+}
+
+void ecpp::rangeClampArray(std::int16_t *values, std::size_t count, std::int16_t from, std::int16_t to) {
+    clampDispatched(values, count, from, to);
+}
+
+void ecpp::rangeClampArray(std::int32_t *values, std::size_t count, std::int32_t from, std::int32_t to) {
+    clampDispatched(values, count, from, to);
+}
+
+void ecpp::rangeClampArray(std::int64_t *values, std::size_t count, std::int64_t from, std::int64_t to) {
+    clampDispatched(values, count, from, to);
+}
+
+void ecpp::rangeClampArray(std::uint8_t *values, std::size_t count, std::uint8_t from, std::uint8_t to) {
+    clampDispatched(values, count, from, to);
+}
+
+void ecpp::rangeClampArray(std::uint16_t *values, std::size_t count, std::uint16_t from, std::uint16_t to) {
+    clampDispatched(values, count, from, to);
+}
+
+void ecpp::rangeClampArray(std::uint32_t *values, std::size_t count, std::uint32_t from, std::uint32_t to) {
+    clampDispatched(values, count, from, to);
+}
+
+void ecpp::rangeClampArray(std::uint64_t *values, std::size_t count, std::uint64_t from, std::uint64_t to) {
+    clampDispatched(values, count, from, to);
+}
+
+void ecpp::rangeClampArray(float *values, std::size_t count, float from, float to) {
+    clampDispatched(values, count, from, to);
+}
+
+void ecpp::rangeClampArray(double *values, std::size_t count, double from, double to) {
+    clampDispatched(values, count, from, to);
+}
+
+bool ecpp::rangeContainsArray(const std::int8_t *values, std::size_t count, std::int8_t from, std::int8_t to) {
+    return containsDispatched(values, count, from, to);
+}
+
+bool ecpp::rangeContainsArray(const std::int16_t *values, std::size_t count, std::int16_t from, std::int16_t to) {
+    return containsDispatched(values, count, from, to);
+}
+
+bool ecpp::rangeContainsArray(const std::int32_t *values, std::size_t count, std::int32_t from, std::int32_t to) {
+    return containsDispatched(values, count, from, to);
+}
+
+bool ecpp::rangeContainsArray(const std::int64_t *values, std::size_t count, std::int64_t from, std::int64_t to) {
+    return containsDispatched(values, count, from, to);
+}
+
+bool ecpp::rangeContainsArray(const std::uint8_t *values, std::size_t count, std::uint8_t from, std::uint8_t to) {
+    return containsDispatched(values, count, from, to);
+}
+
+bool ecpp::rangeContainsArray(const std::uint16_t *values, std::size_t count, std::uint16_t from, std::uint16_t to) {
+    return containsDispatched(values, count, from, to);
+}
+
+bool ecpp::rangeContainsArray(const std::uint32_t *values, std::size_t count, std::uint32_t from, std::uint32_t to) {
+    return containsDispatched(values, count, from, to);
+}
+
+bool ecpp::rangeContainsArray(const std::uint64_t *values, std::size_t count, std::uint64_t from, std::uint64_t to) {
+    return containsDispatched(values, count, from, to);
+}
+
+bool ecpp::rangeContainsArray(const float *values, std::size_t count, float from, float to) {
+    return containsDispatched(values, count, from, to);
+}
+
+bool ecpp::rangeContainsArray(const double *values, std::size_t count, double from, double to) {
+    return containsDispatched(values, count, from, to);
+}
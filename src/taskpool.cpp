@@ -0,0 +1,412 @@
+/*
+ * Copyright 2015 Erik Van Hamme
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "taskpool.h"
+
+#include "utils.h"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <new>
+#include <thread>
+
+namespace {
+
+/*
+ * Chase-Lev deque of fixed capacity, after "Correct and Efficient Work-Stealing for Weak Memory Models" (Le et al.).
+ * The owner pushes and takes at the bottom, thieves steal at the top.
+ */
+template <typename T>
+class StealingDeque {
+public:
+    StealingDeque(std::atomic<T *> *buffer, std::size_t capacity) : _buffer(buffer),
+            _mask(static_cast<std::int64_t>(capacity) - 1), _top(0), _padding(), _bottom(0) {
+        for (std::size_t i = 0; i < capacity; ++i) {
+            new (&_buffer[i]) std::atomic<T *>(nullptr);
+        }
+    }
+
+    std::atomic<T *> *buffer() const {
+        return _buffer;
+    }
+
+    bool push(T *item) {
+        std::int64_t bottom = _bottom.load(std::memory_order_relaxed);
+        std::int64_t top = _top.load(std::memory_order_acquire);
+        if ((bottom - top) > _mask) {
+            return false;
+        }
+
+        _buffer[bottom & _mask].store(item, std::memory_order_relaxed);
+
+        // Publishes the item, and the task it points to, to the thieves.
+        _bottom.store(bottom + 1, std::memory_order_release);
+        return true;
+    }
+
+    T *take() {
+        std::int64_t bottom = _bottom.load(std::memory_order_relaxed) - 1;
+        _bottom.store(bottom, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        std::int64_t top = _top.load(std::memory_order_relaxed);
+
+        if (top > bottom) {
+            _bottom.store(bottom + 1, std::memory_order_relaxed);
+            return nullptr;
+        }
+
+        T *item = _buffer[bottom & _mask].load(std::memory_order_relaxed);
+        if (top == bottom) {
+            // The last item, the thieves may be after it too.
+            if (_top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst,
+                    std::memory_order_relaxed) == false) {
+                item = nullptr;
+            }
+            _bottom.store(bottom + 1, std::memory_order_relaxed);
+        }
+        return item;
+    }
+
+    T *steal() {
+        std::int64_t top = _top.load(std::memory_order_acquire);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        std::int64_t bottom = _bottom.load(std::memory_order_acquire);
+
+        if (top >= bottom) {
+            return nullptr;
+        }
+
+        T *item = _buffer[top & _mask].load(std::memory_order_relaxed);
+        if (_top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed) == false) {
+            // Lost to the owner or another thief.
+            return nullptr;
+        }
+        return item;
+    }
+
+private:
+    std::atomic<T *> *_buffer;
+    std::int64_t _mask;
+
+    // Thieves hammer the top and the owner the bottom, the padding keeps them on different cache lines. Padding
+    // instead of alignas, the deques live in allocator memory that is not aligned to a cache line.
+    std::atomic<std::int64_t> _top;
+    char _padding[64];
+    std::atomic<std::int64_t> _bottom;
+};
+
+// Rounds a worker looks for work before it goes to sleep, and the longest sleep before it looks again.
+constexpr unsigned int IDLE_ROUNDS = 64;
+constexpr std::chrono::milliseconds IDLE_SLEEP(1);
+
+} // anonymous
+
+struct ecpp::TaskPool::Worker {
+    Worker(TaskPool *pool, std::atomic<Task *> *buffer, std::size_t capacity, std::uint32_t seed) : pool(pool),
+            deque(buffer, capacity), freeTasks(nullptr), random(seed) {
+    }
+
+    TaskPool *pool;
+    StealingDeque<Task> deque;
+
+    // Slots released on this worker, only touched by its own thread.
+    Task *freeTasks;
+
+    // Xorshift state to pick the first victim to steal from.
+    std::uint32_t random;
+
+    std::thread thread;
+};
+
+struct ecpp::TaskPool::Shared {
+    std::mutex mutex;
+    std::condition_variable wakeup;
+    std::atomic<bool> stopping;
+    std::atomic<std::size_t> sleepers;
+
+    // Tasks spawned by threads outside the pool, first in first out. Guarded by mutex.
+    Task *injectedHead;
+    Task *injectedTail;
+    std::atomic<std::size_t> injectedCount;
+
+    // Slots released by threads outside the pool. Guarded by mutex.
+    Task *freeTasks;
+};
+
+namespace {
+
+thread_local void *currentWorker = nullptr;
+
+} // anonymous
+
+ecpp::TaskPool::TaskPool(Allocator &allocator, std::size_t workerCount, std::size_t dequeCapacity) :
+        _allocator(allocator), _shared(nullptr), _workers(nullptr), _workerCount(0) {
+
+    void *mem = _allocator.allocate(sizeof(Shared));
+    if (mem == nullptr) {
+        return;
+    }
+    _shared = new (mem) Shared();
+    _shared->stopping.store(false, std::memory_order_relaxed);
+    _shared->sleepers.store(0, std::memory_order_relaxed);
+    _shared->injectedHead = nullptr;
+    _shared->injectedTail = nullptr;
+    _shared->injectedCount.store(0, std::memory_order_relaxed);
+    _shared->freeTasks = nullptr;
+
+    if (workerCount == 0) {
+        workerCount = std::thread::hardware_concurrency();
+        if (workerCount == 0) {
+            workerCount = 1;
+        }
+    }
+    std::size_t capacity = utils::nextPowerOfTwo(dequeCapacity);
+
+    // Without workers, the tasks run on the threads that wait for them.
+    mem = _allocator.allocate(sizeof(Worker) * workerCount);
+    if (mem == nullptr) {
+        return;
+    }
+    _workers = static_cast<Worker *>(mem);
+
+    for (std::size_t i = 0; i < workerCount; ++i) {
+        void *buffer = _allocator.allocate(sizeof(std::atomic<Task *>) * capacity);
+        if (buffer == nullptr) {
+            break;
+        }
+        new (&_workers[i]) Worker(this, static_cast<std::atomic<Task *> *>(buffer), capacity,
+                static_cast<std::uint32_t>((i * 2654435761u) | 1u));
+        ++_workerCount;
+    }
+
+    // Workers only start once all deques exist, thieves look at all of them.
+    for (std::size_t i = 0; i < _workerCount; ++i) {
+        _workers[i].thread = std::thread(&TaskPool::run, this, std::ref(_workers[i]));
+    }
+}
+
+ecpp::TaskPool::~TaskPool() {
+    if (_shared == nullptr) {
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(_shared->mutex);
+        _shared->stopping.store(true, std::memory_order_release);
+    }
+    _shared->wakeup.notify_all();
+
+    for (std::size_t i = 0; i < _workerCount; ++i) {
+        _workers[i].thread.join();
+    }
+
+    // With every group finished, all slots are back on a free list.
+    for (std::size_t i = 0; i < _workerCount; ++i) {
+        Worker &worker = _workers[i];
+        while (worker.freeTasks != nullptr) {
+            Task *task = worker.freeTasks;
+            worker.freeTasks = task->next;
+            _allocator.deallocate(task);
+        }
+        _allocator.deallocate(worker.deque.buffer());
+        worker.~Worker();
+    }
+    if (_workers != nullptr) {
+        _allocator.deallocate(_workers);
+    }
+
+    while (_shared->freeTasks != nullptr) {
+        Task *task = _shared->freeTasks;
+        _shared->freeTasks = task->next;
+        _allocator.deallocate(task);
+    }
+    _shared->~Shared();
+    _allocator.deallocate(_shared);
+}
+
+ecpp::TaskPool::Worker *ecpp::TaskPool::self() const {
+    Worker *worker = static_cast<Worker *>(currentWorker);
+    return ((worker != nullptr) && (worker->pool == this)) ? worker : nullptr;
+}
+
+ecpp::TaskPool::Task *ecpp::TaskPool::acquireTask() {
+    if (_shared == nullptr) {
+        return nullptr;
+    }
+
+    Worker *worker = self();
+    if ((worker != nullptr) && (worker->freeTasks != nullptr)) {
+        Task *task = worker->freeTasks;
+        worker->freeTasks = task->next;
+        return task;
+    }
+
+    std::lock_guard<std::mutex> lock(_shared->mutex);
+    if (_shared->freeTasks != nullptr) {
+        Task *task = _shared->freeTasks;
+        _shared->freeTasks = task->next;
+        return task;
+    }
+    return static_cast<Task *>(_allocator.allocate(sizeof(Task)));
+}
+
+void ecpp::TaskPool::releaseTask(Task *task) {
+    Worker *worker = self();
+    if (worker != nullptr) {
+        task->next = worker->freeTasks;
+        worker->freeTasks = task;
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(_shared->mutex);
+    task->next = _shared->freeTasks;
+    _shared->freeTasks = task;
+}
+
+bool ecpp::TaskPool::push(Task *task) {
+    Worker *worker = self();
+    if (worker != nullptr) {
+        if (worker->deque.push(task) == false) {
+            return false;
+        }
+    } else {
+        std::lock_guard<std::mutex> lock(_shared->mutex);
+        task->next = nullptr;
+        if (_shared->injectedTail != nullptr) {
+            _shared->injectedTail->next = task;
+        } else {
+            _shared->injectedHead = task;
+        }
+        _shared->injectedTail = task;
+        _shared->injectedCount.fetch_add(1, std::memory_order_release);
+    }
+
+    // A sleeper that misses this wakes up after IDLE_SLEEP at the latest.
+    if (_shared->sleepers.load(std::memory_order_seq_cst) != 0) {
+        _shared->wakeup.notify_one();
+    }
+    return true;
+}
+
+void ecpp::TaskPool::execute(Task *task) {
+    TaskGroup *group = task->group;
+
+    task->invoke(task);
+    releaseTask(task);
+
+    // Last, the group may be destroyed as soon as its count drops to 0.
+    group->_pending.fetch_sub(1, std::memory_order_acq_rel);
+}
+
+ecpp::TaskPool::Task *ecpp::TaskPool::findTask(Worker *self) {
+    if (self != nullptr) {
+        Task *task = self->deque.take();
+        if (task != nullptr) {
+            return task;
+        }
+    }
+
+    if ((_shared != nullptr) && (_shared->injectedCount.load(std::memory_order_acquire) != 0)) {
+        std::lock_guard<std::mutex> lock(_shared->mutex);
+        Task *task = _shared->injectedHead;
+        if (task != nullptr) {
+            _shared->injectedHead = task->next;
+            if (_shared->injectedHead == nullptr) {
+                _shared->injectedTail = nullptr;
+            }
+            _shared->injectedCount.fetch_sub(1, std::memory_order_relaxed);
+            return task;
+        }
+    }
+
+    if (_workerCount == 0) {
+        return nullptr;
+    }
+
+    // Every other worker once, starting at a random one so thieves spread out.
+    std::size_t first = 0;
+    if (self != nullptr) {
+        std::uint32_t x = self->random;
+        x ^= x << 13;
+        x ^= x >> 17;
+        x ^= x << 5;
+        self->random = x;
+        first = x % _workerCount;
+    }
+    for (std::size_t i = 0; i < _workerCount; ++i) {
+        Worker &victim = _workers[(first + i) % _workerCount];
+        if (&victim == self) {
+            continue;
+        }
+        Task *task = victim.deque.steal();
+        if (task != nullptr) {
+            return task;
+        }
+    }
+
+    return nullptr;
+}
+
+bool ecpp::TaskPool::helpOnce() {
+    Task *task = findTask(self());
+    if (task == nullptr) {
+        return false;
+    }
+    execute(task);
+    return true;
+}
+
+void ecpp::TaskPool::run(Worker &worker) {
+    currentWorker = &worker;
+
+    unsigned int idle = 0;
+    while (_shared->stopping.load(std::memory_order_acquire) == false) {
+        Task *task = findTask(&worker);
+        if (task != nullptr) {
+            execute(task);
+            idle = 0;
+            continue;
+        }
+
+        if (idle < IDLE_ROUNDS) {
+            ++idle;
+            std::this_thread::yield();
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(_shared->mutex);
+        _shared->sleepers.fetch_add(1, std::memory_order_seq_cst);
+        if ((_shared->injectedHead == nullptr) && (_shared->stopping.load(std::memory_order_relaxed) == false)) {
+            _shared->wakeup.wait_for(lock, IDLE_SLEEP);
+        }
+        _shared->sleepers.fetch_sub(1, std::memory_order_relaxed);
+        idle = 0;
+    }
+
+    currentWorker = nullptr;
+}
+
+void ecpp::TaskGroup::wait() {
+    while (_pending.load(std::memory_order_acquire) != 0) {
+        if (_pool.helpOnce() == false) {
+            std::this_thread::yield();
+        }
+    }
+}
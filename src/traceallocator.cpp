@@ -0,0 +1,370 @@
+/*
+ * Copyright 2015 Erik Van Hamme
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "traceallocator.h"
+
+#include "binarystream.h"
+#include "comparator.h"
+#include "hashmap.h"
+#include "sort.h"
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+
+namespace {
+
+// Saved trace: header, then the events, all little endian.
+constexpr std::uint32_t TRACE_MAGIC = 0x41525445u;
+constexpr std::uint16_t TRACE_VERSION = 1;
+constexpr std::size_t TRACE_HEADER_SIZE = 4 + 2 + 2 + 4 + 8;
+constexpr std::size_t TRACE_EVENT_SIZE = 8 + 4 + 4 + 2 + 1 + 1;
+
+typedef std::chrono::steady_clock Clock;
+
+std::uint64_t microseconds() {
+    return static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(
+            Clock::now().time_since_epoch()).count());
+}
+
+std::uint64_t nanosecondsSince(Clock::time_point start) {
+    return static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            Clock::now() - start).count());
+}
+
+// An allocation of the recording, as it lives on the replay target.
+struct LiveAllocation {
+    void *address;
+    std::size_t size;
+};
+
+typedef ecpp::HashMap<std::uint64_t, LiveAllocation> LiveMap;
+
+// Latencies sorted in ascending order.
+std::uint64_t percentile(const std::uint64_t *latencies, std::size_t count, std::size_t percent) {
+    if (count == 0) {
+        return 0;
+    }
+    return latencies[((count - 1) * percent) / 100];
+}
+
+template <typename Tsource>
+ecpp::ReplayResult replay(const Tsource &source, std::size_t count, ecpp::Allocator &target,
+        ecpp::Allocator &scratch) {
+
+    ecpp::ReplayResult result = ecpp::ReplayResult();
+    result.firstFailure = ecpp::ReplayResult::NO_FAILURE;
+
+    std::size_t allocateCount = 0;
+    std::size_t deallocateCount = 0;
+    for (std::size_t i = 0; i < count; ++i) {
+        ecpp::AllocationEventType type = source(i).type;
+        if ((type == ecpp::AllocationEventType::ALLOCATE) || (type == ecpp::AllocationEventType::ALLOCATE_FAILED)) {
+            ++allocateCount;
+        } else if (type == ecpp::AllocationEventType::DEALLOCATE) {
+            ++deallocateCount;
+        }
+    }
+
+    // The map may be asked to hold every allocation of the trace, when none of them is released.
+    LiveMap live(scratch, (allocateCount != 0) ? allocateCount : 1);
+    std::uint64_t *latencies = static_cast<std::uint64_t *>(scratch.allocate(
+            sizeof(std::uint64_t) * (allocateCount + deallocateCount + 1)));
+    if ((latencies == nullptr) || (live.capacity() == 0)) {
+        if (latencies != nullptr) {
+            scratch.deallocate(latencies);
+        }
+        return result;
+    }
+
+    std::uint64_t *allocateLatencies = latencies;
+    std::uint64_t *deallocateLatencies = latencies + allocateCount;
+
+    std::size_t liveBytes = 0;
+    std::size_t liveCount = 0;
+
+    for (std::size_t i = 0; i < count; ++i) {
+        ecpp::AllocationEvent event = source(i);
+
+        switch (event.type) {
+        case ecpp::AllocationEventType::ALLOCATE:
+        case ecpp::AllocationEventType::ALLOCATE_FAILED: {
+            Clock::time_point start = Clock::now();
+            void *address = target.allocate(event.size);
+            allocateLatencies[result.allocations++] = nanosecondsSince(start);
+
+            if (address == nullptr) {
+                ++result.failures;
+                if (result.firstFailure == ecpp::ReplayResult::NO_FAILURE) {
+                    result.firstFailure = i;
+                }
+            }
+
+            if (event.type == ecpp::AllocationEventType::ALLOCATE_FAILED) {
+                // The recorded program did not get this memory, so it never used or released it.
+                if (address != nullptr) {
+                    target.deallocate(address);
+                }
+                break;
+            }
+
+            // A failed allocation is still remembered, so its release is not counted as unmatched.
+            LiveAllocation allocation = {address, (address != nullptr) ? event.size : 0};
+            live.insert(event.address, allocation);
+            if (address != nullptr) {
+                liveBytes += event.size;
+                ++liveCount;
+                if (liveBytes > result.peakBytes) {
+                    result.peakBytes = liveBytes;
+                }
+                if (liveCount > result.peakCount) {
+                    result.peakCount = liveCount;
+                }
+            }
+            break;
+        }
+
+        case ecpp::AllocationEventType::DEALLOCATE: {
+            LiveAllocation *allocation = live.find(event.address);
+            if (allocation == nullptr) {
+                ++result.unmatched;
+                break;
+            }
+
+            if (allocation->address != nullptr) {
+                Clock::time_point start = Clock::now();
+                target.deallocate(allocation->address);
+                deallocateLatencies[result.deallocations++] = nanosecondsSince(start);
+                liveBytes -= allocation->size;
+                --liveCount;
+            }
+            live.erase(event.address);
+            break;
+        }
+
+        case ecpp::AllocationEventType::RESIZE: {
+            LiveAllocation *allocation = live.find(event.address);
+            if (allocation == nullptr) {
+                ++result.unmatched;
+                break;
+            }
+            if (allocation->address == nullptr) {
+                break;
+            }
+
+            ++result.resizes;
+            if (target.resize(allocation->address, event.size) == true) {
+                liveBytes = (liveBytes - allocation->size) + event.size;
+                allocation->size = event.size;
+                if (liveBytes > result.peakBytes) {
+                    result.peakBytes = liveBytes;
+                }
+            } else {
+                ++result.resizeFailures;
+            }
+            break;
+        }
+
+        default:
+            // Resizes that failed in the recording left the allocation as it was.
+            break;
+        }
+    }
+
+    // Leaves the target as it was before the replay.
+    live.forEach([&target](const std::uint64_t &, LiveAllocation &allocation) {
+        if (allocation.address != nullptr) {
+            target.deallocate(allocation.address);
+        }
+    });
+
+    ecpp::sort(allocateLatencies, result.allocations, ecpp::LessThanComparator<std::uint64_t>::getInstance(),
+            scratch);
+    ecpp::sort(deallocateLatencies, result.deallocations, ecpp::LessThanComparator<std::uint64_t>::getInstance(),
+            scratch);
+
+    result.allocateP50 = percentile(allocateLatencies, result.allocations, 50);
+    result.allocateP90 = percentile(allocateLatencies, result.allocations, 90);
+    result.allocateP99 = percentile(allocateLatencies, result.allocations, 99);
+    result.allocateMax = percentile(allocateLatencies, result.allocations, 100);
+    result.deallocateP50 = percentile(deallocateLatencies, result.deallocations, 50);
+    result.deallocateP99 = percentile(deallocateLatencies, result.deallocations, 99);
+    result.deallocateMax = percentile(deallocateLatencies, result.deallocations, 100);
+
+    scratch.deallocate(latencies);
+
+    result.complete = true;
+
+    return result;
+}
+
+} // anonymous
+
+ecpp::TraceAllocator::TraceAllocator(Allocator &target, void *mem, std::size_t memSize) : _target(target),
+        _ringAllocator(nullptr), _events(static_cast<AllocationEvent *>(mem)),
+        _capacity((mem != nullptr) ? (memSize / sizeof(AllocationEvent)) : 0), _first(0), _size(0), _dropped(0),
+        _start(microseconds()), _tag(0) {
+}
+
+ecpp::TraceAllocator::TraceAllocator(Allocator &target, Allocator &ringAllocator, std::size_t capacity) :
+        _target(target), _ringAllocator(&ringAllocator), _events(nullptr), _capacity(0), _first(0), _size(0),
+        _dropped(0), _start(microseconds()), _tag(0) {
+
+    if (capacity != 0) {
+        _events = static_cast<AllocationEvent *>(ringAllocator.allocate(sizeof(AllocationEvent) * capacity));
+        _capacity = (_events != nullptr) ? capacity : 0;
+    }
+}
+
+ecpp::TraceAllocator::~TraceAllocator() {
+    if ((_ringAllocator != nullptr) && (_events != nullptr)) {
+        _ringAllocator->deallocate(_events);
+    }
+}
+
+void *ecpp::TraceAllocator::allocate(std::size_t size) {
+    return allocate(size, _tag);
+}
+
+void *ecpp::TraceAllocator::allocate(std::size_t size, std::uint16_t tag) {
+    void *address = _target.allocate(size);
+    record((address != nullptr) ? AllocationEventType::ALLOCATE : AllocationEventType::ALLOCATE_FAILED, address,
+            size, tag);
+    return address;
+}
+
+void ecpp::TraceAllocator::deallocate(void *address) {
+    _target.deallocate(address);
+    record(AllocationEventType::DEALLOCATE, address, 0, _tag);
+}
+
+bool ecpp::TraceAllocator::resize(void *address, std::size_t size) {
+    bool resized = _target.resize(address, size);
+    record((resized == true) ? AllocationEventType::RESIZE : AllocationEventType::RESIZE_FAILED, address, size, _tag);
+    return resized;
+}
+
+void ecpp::TraceAllocator::clear() {
+    _first = 0;
+    _size = 0;
+    _dropped = 0;
+}
+
+std::size_t ecpp::TraceAllocator::savedSize(std::size_t count) {
+    return TRACE_HEADER_SIZE + (count * TRACE_EVENT_SIZE);
+}
+
+std::size_t ecpp::TraceAllocator::save(void *mem, std::size_t memSize) const {
+    std::size_t bytes = savedSize(_size);
+
+    BinaryWriter<> writer(mem, memSize);
+    if (writer.require(bytes) == false) {
+        return 0;
+    }
+
+    writer.put<std::uint32_t>(TRACE_MAGIC);
+    writer.put<std::uint16_t>(TRACE_VERSION);
+    writer.put<std::uint16_t>(TRACE_EVENT_SIZE);
+    writer.put<std::uint32_t>(static_cast<std::uint32_t>(_size));
+    writer.put<std::uint64_t>(_dropped);
+
+    for (std::size_t i = 0; i < _size; ++i) {
+        const AllocationEvent &e = event(i);
+        writer.put<std::uint64_t>(e.address);
+        writer.put<std::uint32_t>(e.size);
+        writer.put<std::uint32_t>(e.time);
+        writer.put<std::uint16_t>(e.tag);
+        writer.put<std::uint8_t>(static_cast<std::uint8_t>(e.type));
+        writer.put<std::uint8_t>(0);
+    }
+
+    return bytes;
+}
+
+void ecpp::TraceAllocator::record(AllocationEventType type, const void *address, std::size_t size,
+        std::uint16_t tag) {
+
+    if (_capacity == 0) {
+        ++_dropped;
+        return;
+    }
+
+    std::size_t position = _first + _size;
+    if (position >= _capacity) {
+        position -= _capacity;
+    }
+
+    // A full ring drops its oldest event.
+    if (_size == _capacity) {
+        _first = ((_first + 1) < _capacity) ? (_first + 1) : 0;
+        ++_dropped;
+    } else {
+        ++_size;
+    }
+
+    AllocationEvent &event = _events[position];
+    event.address = static_cast<std::uint64_t>(reinterpret_cast<std::uintptr_t>(address));
+    event.size = (size < std::numeric_limits<std::uint32_t>::max()) ? static_cast<std::uint32_t>(size) :
+            std::numeric_limits<std::uint32_t>::max();
+    event.time = static_cast<std::uint32_t>(microseconds() - _start);
+    event.tag = tag;
+    event.type = type;
+}
+
+ecpp::AllocationTrace::AllocationTrace(const void *data, std::size_t size) : _data(nullptr), _size(0), _dropped(0) {
+    BinaryReader<> reader(data, size);
+    if ((data == nullptr) || (reader.require(TRACE_HEADER_SIZE) == false)) {
+        return;
+    }
+
+    std::uint32_t magic = reader.get<std::uint32_t>();
+    std::uint16_t version = reader.get<std::uint16_t>();
+    std::uint16_t eventSize = reader.get<std::uint16_t>();
+    std::uint32_t count = reader.get<std::uint32_t>();
+    std::uint64_t dropped = reader.get<std::uint64_t>();
+
+    if ((magic != TRACE_MAGIC) || (version != TRACE_VERSION) || (eventSize != TRACE_EVENT_SIZE) ||
+            (count > (reader.remaining() / TRACE_EVENT_SIZE))) {
+        return;
+    }
+
+    _data = static_cast<const std::uint8_t *>(data) + TRACE_HEADER_SIZE;
+    _size = count;
+    _dropped = dropped;
+}
+
+ecpp::AllocationEvent ecpp::AllocationTrace::event(std::size_t index) const {
+    BinaryReader<> reader(_data + (index * TRACE_EVENT_SIZE), TRACE_EVENT_SIZE);
+
+    AllocationEvent e;
+    e.address = reader.get<std::uint64_t>();
+    e.size = reader.get<std::uint32_t>();
+    e.time = reader.get<std::uint32_t>();
+    e.tag = reader.get<std::uint16_t>();
+    e.type = static_cast<AllocationEventType>(reader.get<std::uint8_t>());
+    return e;
+}
+
+ecpp::ReplayResult ecpp::replayTrace(const AllocationEvent *events, std::size_t count, Allocator &target,
+        Allocator &scratch) {
+
+    return replay([events](std::size_t i) { return events[i]; }, count, target, scratch);
+}
+
+ecpp::ReplayResult ecpp::replayTrace(const AllocationTrace &trace, Allocator &target, Allocator &scratch) {
+    return replay([&trace](std::size_t i) { return trace.event(i); }, trace.size(), target, scratch);
+}
@@ -16,80 +16,100 @@
 
 #include "utils.h"
 
+#include "cpufeatures.h"
+
 #include <cstdint>
+#include <cstring>
+
+#ifdef ECPP_X86_DISPATCH
+#include <immintrin.h>
+#endif
+
+namespace {
 
-template<>
-void ecpp::utils::byteSwap<std::uint8_t>(std::uint8_t &subject) {
-    (void) subject;
+// Goes through memcpy so the data does not have to be aligned for T, this still compiles to a load, bswap and store.
+template <typename T>
+void byteSwapScalar(T *data, std::size_t count) {
+    for (std::size_t i = 0; i < count; ++i) {
+        T value;
+        std::memcpy(&value, data + i, sizeof(value));
+        value = ecpp::utils::byteSwapped(value);
+        std::memcpy(data + i, &value, sizeof(value));
+    }
 }
 
-template<>
-void ecpp::utils::byteSwap<std::int8_t>(std::int8_t &subject) {
-    (void) subject;
+#ifdef ECPP_X86_DISPATCH
+
+// Byte order within every 16 byte lane that reverses the bytes of each value of the given size.
+const std::int8_t swapMask16[16] = {1, 0, 3, 2, 5, 4, 7, 6, 9, 8, 11, 10, 13, 12, 15, 14};
+const std::int8_t swapMask32[16] = {3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12};
+const std::int8_t swapMask64[16] = {7, 6, 5, 4, 3, 2, 1, 0, 15, 14, 13, 12, 11, 10, 9, 8};
+
+template <typename T>
+const std::int8_t *swapMask() {
+    return (sizeof(T) == 2) ? swapMask16 : ((sizeof(T) == 4) ? swapMask32 : swapMask64);
 }
 
-template<>
-void ecpp::utils::byteSwap<std::uint16_t>(std::uint16_t &subject) {
-    std::uint8_t a = subject >> 8;
-    std::uint8_t b = subject;
-    subject = (static_cast<std::uint16_t>(b) << 8) | a;
+template <typename T>
+__attribute__((target("ssse3"))) void byteSwapSsse3(T *data, std::size_t count) {
+    std::uint8_t *p = reinterpret_cast<std::uint8_t *>(data);
+    std::size_t bytes = count * sizeof(T);
+    std::size_t done = 0;
+
+    __m128i shuffle = _mm_loadu_si128(reinterpret_cast<const __m128i *>(swapMask<T>()));
+    for (; (done + 16) <= bytes; done += 16) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p + done));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(p + done), _mm_shuffle_epi8(v, shuffle));
+    }
+
+    byteSwapScalar(data + (done / sizeof(T)), count - (done / sizeof(T)));
 }
 
-template<>
-void ecpp::utils::byteSwap<std::int16_t>(std::int16_t &subject) {
-    std::uint8_t a = subject >> 8;
-    std::uint8_t b = subject;
-    subject = (static_cast<std::int16_t>(b) << 8) | a;
+template <typename T>
+__attribute__((target("avx2"))) void byteSwapAvx2(T *data, std::size_t count) {
+    std::uint8_t *p = reinterpret_cast<std::uint8_t *>(data);
+    std::size_t bytes = count * sizeof(T);
+    std::size_t done = 0;
+
+    __m128i lane = _mm_loadu_si128(reinterpret_cast<const __m128i *>(swapMask<T>()));
+    __m256i shuffle = _mm256_broadcastsi128_si256(lane);
+    for (; (done + 32) <= bytes; done += 32) {
+        __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p + done));
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(p + done), _mm256_shuffle_epi8(v, shuffle));
+    }
+    if ((done + 16) <= bytes) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p + done));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(p + done), _mm_shuffle_epi8(v, lane));
+        done += 16;
+    }
+
+    byteSwapScalar(data + (done / sizeof(T)), count - (done / sizeof(T)));
 }
 
-template<>
-void ecpp::utils::byteSwap<std::uint32_t>(std::uint32_t &subject) {
-    std::uint8_t a = subject >> 24;
-    std::uint8_t b = subject >> 16;
-    std::uint8_t c = subject >> 8;
-    std::uint8_t d = subject;
-    subject = (static_cast<std::uint32_t>(d) << 24) | (static_cast<std::uint32_t>(c) << 16) |
-            (static_cast<std::uint32_t>(b) << 8) | a;
+#endif
+
+template <typename T>
+void byteSwapDispatched(T *data, std::size_t count) {
+#ifdef ECPP_X86_DISPATCH
+    static ecpp::CpuDispatch<void(T *, std::size_t)> dispatch(byteSwapScalar<T>, nullptr, byteSwapSsse3<T>,
+            byteSwapAvx2<T>);
+#else
+    static ecpp::CpuDispatch<void(T *, std::size_t)> dispatch(byteSwapScalar<T>);
+#endif
+
+    dispatch.get()(data, count);
 }
 
-template<>
-void ecpp::utils::byteSwap<std::int32_t>(std::int32_t &subject) {
-    std::uint8_t a = subject >> 24;
-    std::uint8_t b = subject >> 16;
-    std::uint8_t c = subject >> 8;
-    std::uint8_t d = subject;
-    subject = (static_cast<std::int32_t>(d) << 24) | (static_cast<std::int32_t>(c) << 16) |
-            (static_cast<std::int32_t>(b) << 8) | a;
+} // anonymous
+
+void ecpp::utils::byteSwapArray(std::uint16_t *data, std::size_t count) {
+    byteSwapDispatched(data, count);
 }
 
-template <>
-void ecpp::utils::byteSwap<std::uint64_t>(std::uint64_t &subject) {
-    std::uint8_t a = subject >> 56;
-    std::uint8_t b = subject >> 48;
-    std::uint8_t c = subject >> 40;
-    std::uint8_t d = subject >> 32;
-    std::uint8_t e = subject >> 24;
-    std::uint8_t f = subject >> 16;
-    std::uint8_t g = subject >> 8;
-    std::uint8_t h = subject;
-    subject = (static_cast<std::uint64_t>(h) << 56) | (static_cast<std::uint64_t>(g) << 48) |
-            (static_cast<std::uint64_t>(f) << 40) | (static_cast<std::uint64_t>(e) << 32) |
-            (static_cast<std::uint64_t>(d) << 24) | (static_cast<std::uint64_t>(c) << 16) |
-            (static_cast<std::uint64_t>(b) << 8) | a;
+void ecpp::utils::byteSwapArray(std::uint32_t *data, std::size_t count) {
+    byteSwapDispatched(data, count);
 }
 
-template <>
-void ecpp::utils::byteSwap<std::int64_t>(std::int64_t &subject) {
-    std::uint8_t a = subject >> 56;
-    std::uint8_t b = subject >> 48;
-    std::uint8_t c = subject >> 40;
-    std::uint8_t d = subject >> 32;
-    std::uint8_t e = subject >> 24;
-    std::uint8_t f = subject >> 16;
-    std::uint8_t g = subject >> 8;
-    std::uint8_t h = subject;
-    subject = (static_cast<std::int64_t>(h) << 56) | (static_cast<std::int64_t>(g) << 48) |
-            (static_cast<std::int64_t>(f) << 40) | (static_cast<std::int64_t>(e) << 32) |
-            (static_cast<std::int64_t>(d) << 24) | (static_cast<std::int64_t>(c) << 16) |
-            (static_cast<std::int64_t>(b) << 8) | a;
+void ecpp::utils::byteSwapArray(std::uint64_t *data, std::size_t count) {
+    byteSwapDispatched(data, count);
 }
@@ -0,0 +1,71 @@
+/*
+ * Copyright 2015 Erik Van Hamme
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "test.h"
+
+#include "fraction.h"
+
+#include <cstdint>
+
+namespace {
+
+typedef ecpp::Fraction<int, int> Signed;
+typedef ecpp::Fraction<unsigned, unsigned> Unsigned;
+typedef ecpp::Fraction<std::uint16_t, std::uint16_t> Unsigned16;
+
+// Exact parts, unlike operator == which compares values.
+template <typename Tnum, typename Tden>
+bool same(const ecpp::Fraction<Tnum, Tden> &a, std::intmax_t num, std::intmax_t den) {
+    return (static_cast<std::intmax_t>(a.getNum()) == num) && (static_cast<std::intmax_t>(a.getDen()) == den);
+}
+
+static_assert(Unsigned(3, 4) - Unsigned(1, 4) == Unsigned(1, 2), "Subtraction is constexpr.");
+
+void signedArithmetic() {
+    CHECK(same(Signed(1, 4) - Signed(3, 4), -1, 2));
+    CHECK(same(Signed(1, 3) + Signed(1, 6), 1, 2));
+    CHECK(same(-Signed(2, -4), 1, 2));
+    CHECK(same(Signed(2, 3) * Signed(3, 4), 1, 2));
+    CHECK(same(Signed(2, 3) / Signed(-4, 3), -1, 2));
+    CHECK(Signed(1, 3) - Signed(1, 2) < Signed(0, 1));
+}
+
+void unsignedArithmetic() {
+    CHECK(same(Unsigned(3, 4) - Unsigned(1, 4), 1, 2));
+    CHECK(same(Unsigned(5, 6) - Unsigned(1, 3), 1, 2));
+    CHECK(same(Unsigned(1, 2) - Unsigned(1, 2), 0, 1));
+    CHECK(same(Unsigned(1, 3) + Unsigned(1, 6), 1, 2));
+    CHECK(same(Unsigned(2, 3) * Unsigned(3, 4), 1, 2));
+    CHECK(same(Unsigned(2, 3) / Unsigned(4, 3), 1, 2));
+
+    Unsigned f(7, 8);
+    f -= Unsigned(3, 8);
+    CHECK(same(f, 1, 2));
+
+    // The intermediates are wide, only the reduced result has to fit.
+    CHECK(same(Unsigned16(65535, 65534) - Unsigned16(1, 65534), 1, 1));
+    CHECK(Unsigned(3, 4) > Unsigned(1, 4));
+    CHECK(12u * Unsigned(3, 4) == 9u);
+}
+
+} // anonymous
+
+int main() {
+    signedArithmetic();
+    unsignedArithmetic();
+
+    return test::result();
+}
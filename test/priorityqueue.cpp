@@ -0,0 +1,110 @@
+/*
+ * Copyright 2015 Erik Van Hamme
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "test.h"
+
+#include "allocator.h"
+#include "comparator.h"
+#include "priorityqueue.h"
+
+#include <string>
+
+namespace {
+
+// Puts the greatest string at the top, the stock comparators only take arithmetic types.
+struct StringGreater {
+    int compare(const std::string &a, const std::string &b) const {
+        return a.compare(b);
+    }
+};
+
+// pop moves the top item out before the heap is repaired, a moved-from std::string is empty and must not be compared.
+void popMovesOutNonTrivialItems() {
+    ecpp::Allocator allocator;
+    ecpp::PriorityQueue<std::string, StringGreater> queue(allocator, 8, StringGreater());
+
+    const char *pushed[] = {"m", "z", "y", "x", "a", "b", "c", "d"};
+    for (const char *item : pushed) {
+        CHECK(queue.push(item) != queue.INVALID_HANDLE);
+    }
+
+    const char *expected[] = {"z", "y", "x", "m", "d", "c", "b", "a"};
+    for (const char *item : expected) {
+        std::string popped;
+        CHECK(queue.pop(popped) == true);
+        CHECK(popped == item);
+    }
+
+    std::string popped;
+    CHECK(queue.pop(popped) == false);
+}
+
+void eraseKeepsHeapOrder() {
+    ecpp::Allocator allocator;
+    ecpp::PriorityQueue<int, ecpp::LessThanComparator<int>, 2> queue(allocator, 16,
+            ecpp::LessThanComparator<int>::getInstance());
+
+    ecpp::PriorityQueue<int, ecpp::LessThanComparator<int>, 2>::Handle handles[16];
+    for (int i = 0; i < 16; ++i) {
+        handles[i] = queue.push((i * 7) % 16);
+    }
+    for (int i = 0; i < 16; i += 3) {
+        CHECK(queue.erase(handles[i]) == true);
+    }
+
+    // Items were pushed in the order of i * 7 % 16, and 7 * 7 % 16 == 1 maps an item back to its i.
+    int previous = -1;
+    int item = 0;
+    int count = 0;
+    while (queue.pop(item) == true) {
+        CHECK(item > previous);
+        CHECK(((item * 7) % 16) % 3 != 0);
+        previous = item;
+        ++count;
+    }
+    CHECK(count == 10);
+}
+
+// Only the abstract Comparator<T> is kept by reference, a stock comparator is copied and may be a temporary.
+void keepsComparators() {
+    ecpp::Allocator allocator;
+    ecpp::PriorityQueue<int, ecpp::GreaterThanComparator<int>> greatest(allocator, 8,
+            ecpp::GreaterThanComparator<int>());
+    ecpp::PriorityQueue<int> smallest(allocator, 8, ecpp::LessThanComparator<int>::getInstance());
+
+    for (int i = 0; i < 8; ++i) {
+        greatest.push((i * 3) % 8);
+        smallest.push((i * 3) % 8);
+    }
+
+    int item = 0;
+    for (int i = 7; i >= 0; --i) {
+        CHECK((greatest.pop(item) == true) && (item == i));
+    }
+    for (int i = 0; i < 8; ++i) {
+        CHECK((smallest.pop(item) == true) && (item == i));
+    }
+}
+
+} // anonymous
+
+int main() {
+    popMovesOutNonTrivialItems();
+    eraseKeepsHeapOrder();
+    keepsComparators();
+
+    return test::result();
+}
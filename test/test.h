@@ -0,0 +1,46 @@
+/*
+ * Copyright 2015 Erik Van Hamme
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef TEST_H
+#define TEST_H
+
+#include <cstdio>
+
+namespace test {
+
+inline int &failures() {
+    static int count = 0;
+    return count;
+}
+
+inline void check(bool condition, const char *expression, const char *file, int line) {
+    if (condition == false) {
+        std::printf("%s:%d: check failed: %s\n", file, line, expression);
+        ++failures();
+    }
+}
+
+// The exit status of a test program, non zero if any check failed.
+inline int result() {
+    return (failures() == 0) ? 0 : 1;
+}
+
+} // test
+
+// Unlike assert this is not compiled out by NDEBUG, and a failure does not stop the test.
+#define CHECK(condition) test::check((condition), #condition, __FILE__, __LINE__)
+
+#endif // TEST_H